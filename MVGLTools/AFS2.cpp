@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <iomanip>
 #include <iosfwd>
@@ -26,12 +27,21 @@ namespace mvgltools::afs2
 
     void extractAFS2(const std::filesystem::path& source, const std::filesystem::path& target)
     {
-        if (std::filesystem::exists(target) && !std::filesystem::is_directory(target))
-            throw std::invalid_argument("Error: Target path exists and is not a directory, aborting.");
         if (!std::filesystem::is_regular_file(source))
             throw std::invalid_argument("Error: Source path doesn't point to a file, aborting.");
 
-        std::ifstream input(source, std::ios::in | std::ios::binary);
+        const FileSource file(source);
+        if (!file) throw std::invalid_argument("Error: Failed to open source file, aborting.");
+
+        extractAFS2(file, target);
+    }
+
+    void extractAFS2(const ByteSource& source, const std::filesystem::path& target)
+    {
+        if (std::filesystem::exists(target) && !std::filesystem::is_directory(target))
+            throw std::invalid_argument("Error: Target path exists and is not a directory, aborting.");
+
+        ByteReader input(source);
 
         AFS2Header header{};
         input.read(reinterpret_cast<char*>(&header), 0x10);
@@ -44,7 +54,8 @@ namespace mvgltools::afs2
         std::vector<uint32_t> offsets(header.numFiles + 1);
         input.read(reinterpret_cast<char*>(offsets.data()), (header.numFiles + 1) * 4L);
 
-        if (input.tellg() < header.blockSize) input.seekg(header.blockSize);
+        if (!input) throw std::invalid_argument(std::format("AFS2: {}", input.error()));
+        if (input.tellg() < static_cast<uint32_t>(header.blockSize)) input.seekg(header.blockSize);
         if (input.tellg() != offsets[0]) throw std::invalid_argument("AFS2: Didn't reach expected end of header.");
 
         if (target.has_parent_path()) std::filesystem::create_directories(target);
@@ -63,6 +74,7 @@ namespace mvgltools::afs2
             std::filesystem::path path(target / sstream.str());
             std::ofstream output(path, std::ios::out | std::ios::binary);
 
+            if (!input) throw std::invalid_argument(std::format("AFS2: {}", input.error()));
             output.write(data.data(), size);
         }
     }
@@ -0,0 +1,272 @@
+#include "ByteSource.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <ios>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    auto checkRange(uint64_t offset, uint64_t count, uint64_t size) -> std::expected<void, std::string>
+    {
+        if (offset > size || count > size - offset)
+            return std::unexpected(
+                std::format("Error: tried to read {} bytes at offset {} of a {} byte source.", count, offset, size));
+        return {};
+    }
+} // namespace
+
+namespace mvgltools
+{
+    auto ByteSource::read(uint64_t offset, uint64_t count) const -> std::expected<std::vector<char>, std::string>
+    {
+        auto range = checkRange(offset, count, size());
+        if (!range) return std::unexpected(range.error());
+
+        std::vector<char> data(count);
+        auto result = readAt(offset, data);
+        if (!result) return std::unexpected(result.error());
+        return data;
+    }
+
+    FileSource::FileSource(const std::filesystem::path& path)
+        : path(path)
+    {
+        std::error_code error;
+        fileSize = std::filesystem::file_size(path, error);
+        if (error) return;
+
+#ifdef _WIN32
+        auto file = CreateFileW(path.c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL,
+                                nullptr);
+        if (file != INVALID_HANDLE_VALUE) handle = file;
+#else
+        handle = open(path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT(cppcoreguidelines-pro-type-vararg)
+#endif
+        if (!*this) fileSize = 0;
+    }
+
+    FileSource::~FileSource()
+    {
+        if (!*this) return;
+#ifdef _WIN32
+        CloseHandle(handle);
+#else
+        close(handle);
+#endif
+    }
+
+    auto FileSource::readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string>
+    {
+        auto range = checkRange(offset, data.size(), fileSize);
+        if (!range) return range;
+
+        // the OS may read less than requested at once
+        while (!data.empty())
+        {
+#ifdef _WIN32
+            OVERLAPPED overlapped{};
+            overlapped.Offset     = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+            DWORD count = 0;
+            auto chunk  = static_cast<DWORD>(std::min<uint64_t>(data.size(), 1ULL << 30));
+            if (!ReadFile(handle, data.data(), chunk, &count, &overlapped) || count == 0)
+                return std::unexpected(std::format("Error: failed to read from {}.", path.string()));
+#else
+            auto count = pread(handle, data.data(), data.size(), static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) return std::unexpected(std::format("Error: failed to read from {}.", path.string()));
+#endif
+            data = data.subspan(count);
+            offset += count;
+        }
+
+        return {};
+    }
+
+    auto FileSource::size() const -> uint64_t
+    {
+        return fileSize;
+    }
+
+    FileSource::operator bool() const
+    {
+#ifdef _WIN32
+        return handle != nullptr;
+#else
+        return handle >= 0;
+#endif
+    }
+
+    MappedSource::MappedSource(const std::filesystem::path& path)
+    {
+        try
+        {
+            // the mapping itself can be closed once the region is mapped
+            const boost::interprocess::file_mapping mapping(path.c_str(), boost::interprocess::read_only);
+            region = std::make_unique<boost::interprocess::mapped_region>(mapping, boost::interprocess::read_only);
+        }
+        catch (const boost::interprocess::interprocess_exception&)
+        {
+            region.reset();
+        }
+    }
+
+    MappedSource::~MappedSource() = default;
+
+    auto MappedSource::readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string>
+    {
+        auto range = checkRange(offset, data.size(), size());
+        if (!range) return range;
+
+        std::ranges::copy(this->data().subspan(offset, data.size()), data.begin());
+        return {};
+    }
+
+    auto MappedSource::size() const -> uint64_t
+    {
+        return region ? region->get_size() : 0;
+    }
+
+    MappedSource::operator bool() const
+    {
+        return region != nullptr;
+    }
+
+    auto MappedSource::data() const -> std::span<const char>
+    {
+        if (!region) return {};
+        return {static_cast<const char*>(region->get_address()), region->get_size()};
+    }
+
+    MemorySource::MemorySource(std::vector<char> buffer)
+        : buffer(std::move(buffer))
+        , view(this->buffer)
+    {
+    }
+
+    MemorySource::MemorySource(std::span<const char> view)
+        : view(view)
+    {
+    }
+
+    auto MemorySource::readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string>
+    {
+        auto range = checkRange(offset, data.size(), size());
+        if (!range) return range;
+
+        std::ranges::copy(view.subspan(offset, data.size()), data.begin());
+        return {};
+    }
+
+    auto MemorySource::size() const -> uint64_t
+    {
+        return view.size();
+    }
+
+    auto MemorySource::data() const -> std::span<const char>
+    {
+        return view;
+    }
+
+    SubSource::SubSource(std::shared_ptr<const ByteSource> parent, uint64_t offset, uint64_t size)
+        : parent(std::move(parent))
+        , offset(offset)
+        , length(size)
+    {
+    }
+
+    auto SubSource::readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string>
+    {
+        auto range = checkRange(offset, data.size(), length);
+        if (!range) return range;
+
+        return parent->readAt(this->offset + offset, data);
+    }
+
+    auto SubSource::size() const -> uint64_t
+    {
+        return length;
+    }
+
+    ByteReader::ByteReader(const ByteSource& source, uint64_t position)
+        : source(source)
+        , position(position)
+    {
+    }
+
+    auto ByteReader::read(char* data, uint64_t count) -> ByteReader&
+    {
+        if (!*this) return *this;
+
+        auto result = source.readAt(position, {data, count});
+        if (!result)
+        {
+            failure = result.error();
+            return *this;
+        }
+
+        position += count;
+        return *this;
+    }
+
+    auto ByteReader::seekg(uint64_t newPosition) -> ByteReader&
+    {
+        position = newPosition;
+        return *this;
+    }
+
+    auto ByteReader::seekg(std::streamoff offset, std::ios::seekdir direction) -> ByteReader&
+    {
+        if (direction == std::ios::cur)
+            position += offset;
+        else if (direction == std::ios::end)
+            position = source.size() + offset;
+        else
+            position = offset;
+        return *this;
+    }
+
+    auto ByteReader::tellg() const -> uint64_t
+    {
+        return position;
+    }
+
+    ByteReader::operator bool() const
+    {
+        return failure.empty();
+    }
+
+    auto ByteReader::error() const -> const std::string&
+    {
+        return failure;
+    }
+} // namespace mvgltools
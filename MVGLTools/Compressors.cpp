@@ -1,19 +1,251 @@
 
 #include "Compressors.h"
 
+#include "Parallel.h"
+
 #include <Common.h>
 #include <Compressor.h>
 #include <Decompressor.h>
 #include <lz4hc.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <format>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+namespace
+{
+    constexpr auto toDobozLevel(mvgltools::CompressionLevel level) -> doboz::CompressionLevel
+    {
+        switch (level)
+        {
+            case mvgltools::CompressionLevel::FAST: return doboz::COMPRESSION_LEVEL_GREEDY;
+            case mvgltools::CompressionLevel::BALANCED: return doboz::COMPRESSION_LEVEL_LAZY;
+            case mvgltools::CompressionLevel::BEST: [[fallthrough]];
+            default: return doboz::COMPRESSION_LEVEL_BEST;
+        }
+    }
+
+    constexpr auto toLZ4Level(mvgltools::CompressionLevel level) -> int32_t
+    {
+        switch (level)
+        {
+            case mvgltools::CompressionLevel::FAST: return LZ4HC_CLEVEL_MIN;
+            case mvgltools::CompressionLevel::BALANCED: return LZ4HC_CLEVEL_DEFAULT;
+            case mvgltools::CompressionLevel::BEST: [[fallthrough]];
+            default: return LZ4HC_CLEVEL_MAX;
+        }
+    }
+
+    // inputs of at least this size get split into regions that are parsed in parallel
+    constexpr size_t DOBOZ_PARALLEL_THRESHOLD = 16 * 1024 * 1024;
+    // every region re-reads the preceding dictionary window, so regions are much larger than it
+    constexpr size_t DOBOZ_REGION_SIZE = 8 * 1024 * 1024;
+
+    auto compressDobozParallel(const std::vector<char>& input) -> std::expected<std::vector<char>, std::string>
+    {
+        auto regionCount = (input.size() + DOBOZ_REGION_SIZE - 1) / DOBOZ_REGION_SIZE;
+        std::vector<std::vector<doboz::Sequence>> regions(regionCount);
+
+        // runs on the shared pool, as this is usually called by one of many threads packing an archive
+        auto parseRegion = [&](size_t i)
+        {
+            auto start = i * DOBOZ_REGION_SIZE;
+            auto end   = std::min(start + DOBOZ_REGION_SIZE, input.size());
+            doboz::Compressor comp;
+            comp.parseRegion(input.data(), start, end, regions[i]);
+        };
+        mvgltools::parallelFor(regionCount, parseRegion);
+
+        doboz::Compressor comp;
+        auto maxSize = doboz::Compressor::getMaxCompressedSize(input.size());
+        std::vector<char> output(maxSize);
+        size_t destSize = 0;
+
+        auto result = comp.compressRegions(
+            input.data(), input.size(), regions.data(), regions.size(), output.data(), output.size(), destSize);
+
+        if (result != doboz::RESULT_OK)
+            return std::unexpected(std::format("Error: something went wrong while compressing, doboz error code: {}",
+                                               std::to_underlying(result)));
+
+        output.resize(destSize);
+        return output;
+    }
+
+    // inputs of at least this size get split into chunks that are compressed in parallel
+    constexpr size_t LZ4_PARALLEL_THRESHOLD = 16 * 1024 * 1024;
+    constexpr size_t LZ4_CHUNK_SIZE         = 4 * 1024 * 1024;
+    // LZ4 can't reference data further back than this, so it's all the dictionary a chunk needs
+    constexpr size_t LZ4_DICTIONARY_SIZE = 64 * 1024;
+    constexpr size_t LZ4_MIN_MATCH       = 4;
+    constexpr uint8_t LZ4_RUN_MASK       = 15;
+
+    /**
+     * Compresses input[start, end) as an LZ4 block, using the preceding 64 KiB as prefix dictionary.
+     * The chunk stays in place, so its matches can reference the dictionary with regular offsets.
+     */
+    auto compressLZ4Chunk(const std::vector<char>& input, size_t start, size_t end, int32_t level) -> std::vector<char>
+    {
+        std::unique_ptr<LZ4_streamHC_t, decltype(&LZ4_freeStreamHC)> stream(LZ4_createStreamHC(), &LZ4_freeStreamHC);
+        if (!stream) return {};
+
+        LZ4_resetStreamHC_fast(stream.get(), level);
+
+        auto dictStart = start - std::min(start, LZ4_DICTIONARY_SIZE);
+        if (dictStart != start)
+            LZ4_loadDictHC(stream.get(), input.data() + dictStart, static_cast<int32_t>(start - dictStart));
+
+        auto inSize  = static_cast<int32_t>(end - start);
+        auto outSize = LZ4_compressBound(inSize);
+        std::vector<char> output(outSize);
+
+        auto result = LZ4_compress_HC_continue(stream.get(), input.data() + start, output.data(), inSize, outSize);
+
+        output.resize(result);
+        return output;
+    }
+
+    auto writeLZ4Length(std::vector<char>& output, size_t length) -> void
+    {
+        for (; length >= 255; length -= 255)
+            output.push_back(static_cast<char>(255));
+        output.push_back(static_cast<char>(length));
+    }
+
+    auto readLZ4Length(const uint8_t*& data, size_t length) -> size_t
+    {
+        if (length != LZ4_RUN_MASK) return length;
+
+        uint8_t value = 0;
+        do
+        {
+            value = *data++;
+            length += value;
+        } while (value == 255);
+
+        return length;
+    }
+
+    /**
+     * Writes a single LZ4 sequence, taking the literals from the input data.
+     * A matchLength of 0 writes the final, literal only sequence of a block.
+     */
+    auto writeLZ4Sequence(std::vector<char>& output,
+                          const std::vector<char>& input,
+                          size_t literalStart,
+                          size_t literalEnd,
+                          uint16_t offset,
+                          size_t matchLength) -> void
+    {
+        auto literalLength = literalEnd - literalStart;
+        auto matchCode     = matchLength == 0 ? 0 : matchLength - LZ4_MIN_MATCH;
+
+        auto token = std::min<size_t>(literalLength, LZ4_RUN_MASK) << 4 | std::min<size_t>(matchCode, LZ4_RUN_MASK);
+        output.push_back(static_cast<char>(token));
+        if (literalLength >= LZ4_RUN_MASK) writeLZ4Length(output, literalLength - LZ4_RUN_MASK);
+        output.insert(output.end(), input.begin() + literalStart, input.begin() + literalEnd);
+
+        if (matchLength == 0) return;
+
+        output.push_back(static_cast<char>(offset & 0xFF));
+        output.push_back(static_cast<char>(offset >> 8));
+        if (matchCode >= LZ4_RUN_MASK) writeLZ4Length(output, matchCode - LZ4_RUN_MASK);
+    }
+
+    /**
+     * Joins independently compressed chunks into a single LZ4 block.
+     *
+     * Every chunk ends with a literal only sequence, which isn't allowed in the middle of a block. These literals get
+     * merged into the first sequence of the next chunk, all other sequences are copied as they are.
+     */
+    auto stitchLZ4Chunks(const std::vector<char>& input, const std::vector<std::vector<char>>& chunks)
+        -> std::expected<std::vector<char>, std::string>
+    {
+        size_t totalSize = 0;
+        for (const auto& chunk : chunks)
+            totalSize += chunk.size();
+
+        std::vector<char> output;
+        // merging literals never grows the data, so the sum of the chunks is an upper bound
+        output.reserve(totalSize);
+
+        // literals are copies of the input, so pending literals are tracked as input positions
+        size_t literalStart = 0;
+        size_t position     = 0;
+
+        for (const auto& chunk : chunks)
+        {
+            const auto* data         = reinterpret_cast<const uint8_t*>(chunk.data());
+            const auto* end          = data + chunk.size();
+            const uint8_t* copyStart = nullptr;
+
+            while (data < end)
+            {
+                const auto* sequenceStart = data;
+                auto token                = *data++;
+
+                auto literalLength = readLZ4Length(data, token >> 4);
+                data += literalLength;
+                position += literalLength;
+
+                // the chunk's final sequence, its literals get merged into the next one
+                if (data >= end)
+                {
+                    // a chunk without any matches just extends the pending literals
+                    if (copyStart == nullptr) break;
+
+                    output.insert(output.end(), copyStart, sequenceStart);
+                    literalStart = position - literalLength;
+                    break;
+                }
+
+                auto offset = static_cast<uint16_t>(data[0] | data[1] << 8);
+                data += 2;
+                auto matchLength = readLZ4Length(data, token & LZ4_RUN_MASK) + LZ4_MIN_MATCH;
+                position += matchLength;
+
+                if (copyStart == nullptr)
+                {
+                    writeLZ4Sequence(output, input, literalStart, position - matchLength, offset, matchLength);
+                    copyStart = data;
+                }
+            }
+        }
+
+        if (position != input.size()) return std::unexpected("Error: LZ4 chunks don't match the input size.");
+
+        writeLZ4Sequence(output, input, literalStart, position, 0, 0);
+        return output;
+    }
+
+    auto compressLZ4Parallel(const std::vector<char>& input, int32_t level)
+        -> std::expected<std::vector<char>, std::string>
+    {
+        auto chunkCount = (input.size() + LZ4_CHUNK_SIZE - 1) / LZ4_CHUNK_SIZE;
+        std::vector<std::vector<char>> chunks(chunkCount);
+
+        // runs on the shared pool, as this is usually called by one of many threads packing an archive
+        auto compressChunk = [&](size_t i)
+        {
+            auto start = i * LZ4_CHUNK_SIZE;
+            auto end   = std::min(start + LZ4_CHUNK_SIZE, input.size());
+            chunks[i]  = compressLZ4Chunk(input, start, end, level);
+        };
+        mvgltools::parallelFor(chunkCount, compressChunk);
+
+        if (std::ranges::any_of(chunks, [](const auto& chunk) { return chunk.empty(); }))
+            return std::unexpected("Error: something went wrong while compressing.");
+
+        return stitchLZ4Chunks(input, chunks);
+    }
+} // namespace
+
 namespace mvgltools
 {
     auto Doboz::decompress(const std::vector<char>& input, size_t size) -> std::expected<std::vector<char>, std::string>
@@ -37,14 +269,20 @@ namespace mvgltools
         return output;
     }
 
-    auto Doboz::compress(const std::vector<char>& input) -> std::expected<std::vector<char>, std::string>
+    auto Doboz::compress(const std::vector<char>& input, CompressionLevel level)
+        -> std::expected<std::vector<char>, std::string>
     {
+        // the faster levels don't use the binary tree match finder, which is what dominates the compression time
+        if (level == CompressionLevel::BEST && input.size() >= DOBOZ_PARALLEL_THRESHOLD)
+            return compressDobozParallel(input);
+
         doboz::Compressor comp;
         auto maxSize = doboz::Compressor::getMaxCompressedSize(input.size());
         std::vector<char> output(maxSize);
         size_t destSize = 0;
 
-        auto result = comp.compress(input.data(), input.size(), output.data(), output.size(), destSize);
+        auto result =
+            comp.compress(input.data(), input.size(), output.data(), output.size(), destSize, toDobozLevel(level));
 
         if (result != doboz::RESULT_OK)
             return std::unexpected(std::format("Error: something went wrong while compressing, doboz error code: {}",
@@ -81,13 +319,16 @@ namespace mvgltools
         return output;
     }
 
-    auto LZ4::compress(const std::vector<char>& input) -> std::expected<std::vector<char>, std::string>
+    auto LZ4::compress(const std::vector<char>& input, CompressionLevel level)
+        -> std::expected<std::vector<char>, std::string>
     {
+        if (input.size() >= LZ4_PARALLEL_THRESHOLD) return compressLZ4Parallel(input, toLZ4Level(level));
+
         auto inSize  = static_cast<int32_t>(input.size());
         auto outSize = LZ4_compressBound(inSize);
         std::vector<char> output(outSize);
 
-        auto result = LZ4_compress_HC(input.data(), output.data(), inSize, outSize, LZ4HC_CLEVEL_MAX);
+        auto result = LZ4_compress_HC(input.data(), output.data(), inSize, outSize, toLZ4Level(level));
         if (result == 0) return std::unexpected(std::format("Error: something went wrong while compressing."));
 
         output.resize(result);
@@ -1,28 +1,35 @@
 #include "EXPA.h"
 
 #include "Helpers.h"
+#include "Parallel.h"
 
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree_fwd.hpp>
 #include <boost/regex.hpp>
 #include <boost/regex/v5/regex_fwd.hpp>
 #include <boost/regex/v5/regex_search.hpp>
-#include <parser.hpp>
 
 #include <algorithm>
-#include <bitset>
+#include <array>
+#include <bit>
+#include <charconv>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <expected>
 #include <filesystem>
 #include <format>
 #include <fstream>
-#include <iomanip>
 #include <ios>
+#include <iterator>
+#include <memory>
 #include <optional>
 #include <ranges>
-#include <sstream>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -70,63 +77,277 @@ namespace
         }
     }
 
-    auto getCSVString(const EntryType& type, const EntryValue& value) -> std::string
+    auto toView(const EntryValue& value) -> EntryValueView
+    {
+        return std::visit(
+            [](const auto& val) -> EntryValueView
+            {
+                using T = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<T, std::vector<int32_t>>)
+                    return std::span<const int32_t>(val);
+                else if constexpr (std::is_same_v<T, std::string>)
+                    return std::string_view(val);
+                else
+                    return val;
+            },
+            value);
+    }
+
+    auto toValue(const EntryValueView& value) -> EntryValue
+    {
+        return std::visit(
+            [](const auto& val) -> EntryValue
+            {
+                using T = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<T, std::span<const int32_t>>)
+                    return std::vector<int32_t>(val.begin(), val.end());
+                else if constexpr (std::is_same_v<T, std::string_view>)
+                    return std::string(val);
+                else
+                    return val;
+            },
+            value);
+    }
+
+    auto getDefaultValue(EntryType type) -> EntryValueView
+    {
+        switch (type)
+        {
+            case EntryType::INT32: return int32_t{0};
+            case EntryType::INT16: return int16_t{0};
+            case EntryType::INT8: return int8_t{0};
+            case EntryType::FLOAT: return 0.0F;
+            case EntryType::BOOL: return false;
+            case EntryType::STRING3: [[fallthrough]];
+            case EntryType::STRING: [[fallthrough]];
+            case EntryType::STRING2: return std::string_view{};
+            case EntryType::INT32_ARRAY: return std::span<const int32_t>{};
+            case EntryType::EMPTY: [[fallthrough]];
+            case EntryType::UNK1: [[fallthrough]];
+            default: return std::nullopt;
+        }
+    }
+
+    template<typename T>
+    void appendValue(std::vector<char>& values, T value)
+    {
+        auto offset = values.size();
+        values.resize(offset + sizeof(T));
+        std::memcpy(values.data() + offset, &value, sizeof(T));
+    }
+
+    // CSV output is collected and written in blocks of this size, so writing a file takes few syscalls
+    constexpr size_t CSV_BLOCK_SIZE = 1024 * 1024;
+
+    template<typename T>
+    void appendNumber(std::string& buffer, T value)
+    {
+        // enough for any int32 and the shortest round trip representation of any float
+        std::array<char, 32> data{};
+        auto result = std::to_chars(data.data(), data.data() + data.size(), value);
+        buffer.append(data.data(), result.ptr);
+    }
+
+    void appendQuoted(std::string& buffer, std::string_view value)
+    {
+        buffer += '"';
+        for (auto pos = value.find('"'); pos != std::string_view::npos; pos = value.find('"'))
+        {
+            buffer.append(value.substr(0, pos + 1));
+            buffer += '"';
+            value.remove_prefix(pos + 1);
+        }
+        buffer.append(value);
+        buffer += '"';
+    }
+
+    void appendCSVValue(std::string& buffer, EntryType type, const EntryValueView& value)
     {
         switch (type)
         {
-            case EntryType::INT32: return std::format("{}", std::get<int32_t>(value));
-            case EntryType::INT16: return std::format("{}", std::get<int16_t>(value));
-            case EntryType::INT8: return std::format("{}", std::get<int8_t>(value));
-            case EntryType::FLOAT: return std::format("{}", std::get<float>(value));
-            case EntryType::BOOL: return std::format("{}", std::get<bool>(value));
+            case EntryType::INT32: appendNumber(buffer, std::get<int32_t>(value)); break;
+            case EntryType::INT16: appendNumber(buffer, std::get<int16_t>(value)); break;
+            case EntryType::INT8: appendNumber(buffer, std::get<int8_t>(value)); break;
+            case EntryType::FLOAT: appendNumber(buffer, std::get<float>(value)); break;
+            case EntryType::BOOL: buffer.append(std::get<bool>(value) ? "true" : "false"); break;
 
             case EntryType::STRING3: [[fallthrough]];
             case EntryType::STRING: [[fallthrough]];
-            case EntryType::STRING2:
-            {
-                std::stringstream sstream;
-                sstream << std::quoted(std::get<std::string>(value), '\"', '\"');
-                return sstream.str();
-            }
+            case EntryType::STRING2: appendQuoted(buffer, std::get<std::string_view>(value)); break;
             case EntryType::INT32_ARRAY:
             {
-                auto data = std::get<std::vector<int32_t>>(value) |
-                            std::views::transform([](auto val) { return std::to_string(val); });
-                return std::views::join_with(data, ' ') | std::ranges::to<std::string>();
+                auto first = true;
+                for (auto val : std::get<std::span<const int32_t>>(value))
+                {
+                    if (!first) buffer += ' ';
+                    appendNumber(buffer, val);
+                    first = false;
+                }
+                break;
             }
             case EntryType::EMPTY: [[fallthrough]];
             case EntryType::UNK1: [[fallthrough]];
-            default: return "";
+            default: break;
+        }
+    }
+
+    template<typename TableType>
+    auto exportCSVTables(const std::vector<TableType>& tables, const std::filesystem::path& target)
+        -> std::expected<void, std::string>
+    {
+        if (std::filesystem::exists(target) && !std::filesystem::is_directory(target))
+            return std::unexpected("Target path exists and is not a directory.");
+
+        std::filesystem::create_directories(target);
+
+        // shared by all files, so it only gets allocated once
+        std::string buffer;
+        buffer.reserve(CSV_BLOCK_SIZE * 2);
+
+        int32_t table_id = 0;
+        for (const auto& table : tables)
+        {
+            const auto& name = detail::getTableName(table);
+            auto path        = target / std::format("{:03}_{}.csv", table_id++, name);
+            std::ofstream stream(path, std::ios::out);
+
+            if (!stream) return std::unexpected("Failed to write target file.");
+
+            buffer = detail::getTableStructure(table).getCSVHeader();
+            buffer += '\n';
+
+            auto count = detail::getTableEntryCount(table);
+            for (size_t row = 0; row < count; row++)
+            {
+                if constexpr (std::is_same_v<TableType, ColumnarTable>)
+                    table.writeCSV(row, buffer);
+                else
+                    table.structure.writeCSV(table.entries[row], buffer);
+                buffer += '\n';
+
+                if (buffer.size() < CSV_BLOCK_SIZE) continue;
+
+                stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+
+            stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (!stream) return std::unexpected(std::format("Failed to write {}.", path.string()));
+        }
+
+        return {};
+    }
+
+    template<typename T>
+    auto parseCSVNumber(std::string_view value) -> std::optional<T>
+    {
+        // as lenient as std::stoi and std::stof, which were used before
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            value.remove_prefix(1);
+        if (value.starts_with('+') && !value.substr(1).starts_with('-')) value.remove_prefix(1);
+
+        T result{};
+        auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (error != std::errc{}) return std::nullopt;
+        return result;
+    }
+
+    // appends the space separated numbers of value to array
+    auto parseCSVArray(std::string_view value, std::vector<int32_t>& array) -> bool
+    {
+        for (const auto& val : value | std::views::split(' '))
+        {
+            if (val.empty()) continue;
+
+            auto number = parseCSVNumber<int32_t>(std::string_view(val.begin(), val.end()));
+            if (!number) return false;
+            array.push_back(number.value());
         }
+        return true;
     }
 
-    auto getCSVValue(const EntryType& type, const std::string& value) -> EntryValue
+    auto getCSVValue(EntryType type, std::string_view value) -> std::optional<EntryValue>
     {
         switch (type)
         {
             default:
             case EntryType::UNK1: [[fallthrough]];
-            case EntryType::EMPTY: return std::nullopt;
+            case EntryType::EMPTY: return EntryValue{std::nullopt};
 
-            case EntryType::INT32: return std::stoi(value);
-            case EntryType::INT16: return static_cast<int16_t>(std::stoi(value));
-            case EntryType::INT8: return static_cast<int8_t>(std::stoi(value));
-            case EntryType::FLOAT: return std::stof(value);
+            case EntryType::INT32: return parseCSVNumber<int32_t>(value);
+            // narrowed like before, so out of range values wrap around
+            case EntryType::INT16:
+                if (auto number = parseCSVNumber<int32_t>(value)) return static_cast<int16_t>(number.value());
+                return std::nullopt;
+            case EntryType::INT8:
+                if (auto number = parseCSVNumber<int32_t>(value)) return static_cast<int8_t>(number.value());
+                return std::nullopt;
+            case EntryType::FLOAT: return parseCSVNumber<float>(value);
 
             case EntryType::STRING3: [[fallthrough]];
             case EntryType::STRING: [[fallthrough]];
-            case EntryType::STRING2: return value;
+            case EntryType::STRING2: return std::string(value);
 
             case EntryType::BOOL: return value == "true";
             case EntryType::INT32_ARRAY:
-                return value | std::views::split(' ') | std::ranges::to<std::vector<std::string>>() |
-                       std::views::transform([](const auto& val) { return std::stoi(val); }) |
-                       std::ranges::to<std::vector<int32_t>>();
+            {
+                std::vector<int32_t> array;
+                if (!parseCSVArray(value, array)) return std::nullopt;
+                return array;
+            }
+        }
+    }
+
+    auto getInvalidValueError(EntryType type, std::string_view value, size_t column) -> std::string
+    {
+        return std::format("Invalid {} value '{}' in column {}.", detail::toString(type), value, column);
+    }
+
+    constexpr auto broadcast(char value) -> uint64_t
+    {
+        return 0x0101010101010101ULL * static_cast<uint8_t>(value);
+    }
+
+    // sets the high bit of exactly the bytes of word that are equal to the bytes of pattern
+    constexpr auto matchBytes(uint64_t word, uint64_t pattern) -> uint64_t
+    {
+        constexpr uint64_t LOW_BITS = 0x7F7F7F7F7F7F7F7FULL;
+
+        auto diff = word ^ pattern;
+        return ~(((diff & LOW_BITS) + LOW_BITS) | diff | LOW_BITS);
+    }
+
+    // finds the next delimiter or line break, checking 8 bytes at once
+    auto findFieldEnd(const char* pos, const char* end) -> const char*
+    {
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            while (end - pos >= 8)
+            {
+                uint64_t word = 0;
+                std::memcpy(&word, pos, sizeof(word));
+
+                auto matches = matchBytes(word, broadcast(',')) | matchBytes(word, broadcast('\n')) |
+                               matchBytes(word, broadcast('\r'));
+                if (matches != 0) return pos + (std::countr_zero(matches) / 8);
+                pos += 8;
+            }
         }
+
+        while (pos != end && *pos != ',' && *pos != '\n' && *pos != '\r')
+            pos++;
+        return pos;
+    }
+
+    auto findQuote(const char* pos, const char* end) -> const char*
+    {
+        // memchr is vectorized by the standard libraries
+        const auto* quote = std::memchr(pos, '"', end - pos);
+        return quote == nullptr ? end : static_cast<const char*>(quote);
     }
 
-    auto writeEXPAEntry(size_t base_offset, char* data, EntryType type, const EntryValue& value)
-        -> std::optional<CHNKEntry>
+    // writes a value into its place in a row, returns the offset of the CHNK pointer within the value if it has one
+    auto writeEXPAEntry(char* data, EntryType type, const EntryValueView& value) -> std::optional<uint32_t>
     {
         switch (type)
         {
@@ -140,16 +361,15 @@ namespace
             case EntryType::STRING2:
             {
                 *reinterpret_cast<uint64_t*>(data) = 0;
-                auto str                           = get<std::string>(value);
-                if (!str.empty()) return CHNKEntry(base_offset, str);
+                if (!get<std::string_view>(value).empty()) return 0;
                 break;
             }
             case EntryType::INT32_ARRAY:
             {
-                const auto& array                      = get<std::vector<int32_t>>(value);
+                auto array                             = get<std::span<const int32_t>>(value);
                 *reinterpret_cast<uint32_t*>(data)     = static_cast<int32_t>(array.size());
                 *reinterpret_cast<uint64_t*>(data + 8) = 0;
-                if (!array.empty()) return CHNKEntry(base_offset + 8, array);
+                if (!array.empty()) return 8;
                 break;
             }
 
@@ -161,6 +381,68 @@ namespace
         return std::nullopt;
     }
 
+    auto hasChunk(EntryType type) -> bool
+    {
+        return type == EntryType::STRING || type == EntryType::STRING2 || type == EntryType::STRING3 ||
+               type == EntryType::INT32_ARRAY;
+    }
+
+    // the size of the CHNK value of an entry, 0 if it doesn't have one
+    auto getChunkSize(const EntryValueView& value) -> uint32_t
+    {
+        if (const auto* str = std::get_if<std::string_view>(&value))
+            return str->empty() ? 0 : static_cast<uint32_t>(ceilInteger(static_cast<int64_t>(str->size() + 2), 4));
+        if (const auto* array = std::get_if<std::span<const int32_t>>(&value))
+            return static_cast<uint32_t>(array->size_bytes());
+        return 0;
+    }
+
+    template<typename T>
+    auto writeData(char* dest, const T& value) -> char*
+    {
+        std::memcpy(dest, &value, sizeof(T));
+        return dest + sizeof(T);
+    }
+
+    // writes a CHNK entry, the padding of the value has to be zeroed already. There is no way to share a value between
+    // entries, as the pointer at offset gets resolved to the value following the entry, so duplicates are written again
+    auto writeChunkEntry(char* dest, uint32_t offset, const EntryValueView& value) -> char*
+    {
+        const auto size = getChunkSize(value);
+        dest            = writeData(dest, offset);
+        dest            = writeData(dest, size);
+
+        if (const auto* str = std::get_if<std::string_view>(&value))
+            std::ranges::copy(*str, dest);
+        else
+        {
+            auto array = get<std::span<const int32_t>>(value);
+            std::memcpy(dest, array.data(), array.size_bytes());
+        }
+
+        return dest + size;
+    }
+
+    auto getRowLength(const Table& table, size_t row) -> size_t
+    {
+        return std::min(table.structure.getEntryCount(), table.entries[row].size());
+    }
+
+    auto getRowLength(const ColumnarTable& table, size_t /*row*/) -> size_t
+    {
+        return table.getStructure().getEntryCount();
+    }
+
+    auto getRowValue(const Table& table, size_t row, size_t column) -> EntryValueView
+    {
+        return toView(table.entries[row][column]);
+    }
+
+    auto getRowValue(const ColumnarTable& table, size_t row, size_t column) -> EntryValueView
+    {
+        return table.getValue(row, column);
+    }
+
     auto readEXPAEntry(EntryType type, const char* data, uint32_t bitCounter) -> EntryValue
     {
         switch (type)
@@ -200,6 +482,41 @@ namespace mvgltools::expa
     Structure::Structure(std::vector<StructureEntry> structure)
         : structure(std::move(structure))
     {
+        auto offset     = 0u;
+        auto bitCounter = 0u;
+
+        for (const auto& val : this->structure)
+        {
+            if (val.type != EntryType::BOOL || bitCounter >= 32)
+            {
+                if (bitCounter > 0) offset += getSize(EntryType::BOOL);
+
+                offset     = ceilInteger(offset, getAlignment(val.type));
+                bitCounter = 0;
+            }
+
+            fields.emplace_back(offset, val.type, bitCounter);
+
+            if (val.type == EntryType::BOOL)
+                bitCounter++;
+            else
+                offset += getSize(val.type);
+        }
+
+        // the size is calculated separately, as it aligns the first bool of a word while the row layout doesn't
+        bitCounter = 0;
+        for (const auto& val : this->structure)
+        {
+            if (bitCounter == 0 || bitCounter >= 32 || val.type != EntryType::BOOL)
+            {
+                expaSize   = ceilInteger(expaSize, getAlignment(val.type));
+                bitCounter = 0;
+            }
+
+            if (bitCounter == 0) expaSize += getSize(val.type);
+            if (val.type == EntryType::BOOL) bitCounter++;
+        }
+        expaSize = ceilInteger(expaSize, 8);
     }
 
     auto Structure::getStructure() const -> std::vector<StructureEntry>
@@ -207,80 +524,89 @@ namespace mvgltools::expa
         return structure;
     }
 
-    auto Structure::writeEXPA(const std::vector<EntryValue>& entries) const -> EXPAEntry
+    template<typename Getter, typename ChunkHandler>
+    void Structure::writeEXPA(char* data, size_t count, Getter getValue, ChunkHandler addChunk) const
     {
-        auto offset     = 0u;
-        auto bitCounter = 0;
-        std::bitset<32> currentBool;
-        std::vector<CHNKEntry> chunkEntries;
-        std::vector<char> new_data(getEXPASize(), '\xCC');
+        std::fill_n(data, expaSize, '\xCC');
 
-        for (const auto& val : std::views::zip(structure, entries))
+        for (size_t i = 0; i < count; i++)
         {
-            auto type  = get<0>(val).type;
-            auto entry = get<1>(val);
+            const auto& field = fields[i];
+            auto* fieldData   = data + field.offset;
 
-            if (type != EntryType::BOOL || bitCounter >= 32)
+            if (field.type == EntryType::BOOL)
             {
-                if (bitCounter > 0)
-                {
-                    *reinterpret_cast<uint32_t*>(new_data.data() + offset) = currentBool.to_ulong();
-                    offset += sizeof(uint32_t);
-                    bitCounter  = 0;
-                    currentBool = {};
-                }
-                offset = ceilInteger(offset, getAlignment(type));
+                // the first bool of a word clears it
+                auto& word = *reinterpret_cast<uint32_t*>(fieldData);
+                if (field.bit == 0) word = 0;
+                word |= static_cast<uint32_t>(get<bool>(getValue(i))) << field.bit;
+                continue;
             }
 
-            auto result = writeEXPAEntry(offset, new_data.data() + offset, type, entry);
-            if (result) chunkEntries.push_back(result.value());
+            auto value  = getValue(i);
+            auto result = writeEXPAEntry(fieldData, field.type, value);
+            if (result) addChunk(field.offset + result.value(), value);
+        }
+    }
+
+    template<typename Getter>
+    auto Structure::writeEXPA(size_t count, Getter getValue) const -> EXPAEntry
+    {
+        EXPAEntry entry{.data = std::vector<char>(expaSize), .chunk = {}};
 
-            if (type == EntryType::BOOL)
-                currentBool.set(bitCounter++, get<bool>(entry));
+        auto addChunk = [&](uint32_t offset, const EntryValueView& value)
+        {
+            if (const auto* str = std::get_if<std::string_view>(&value))
+                entry.chunk.emplace_back(offset, *str);
             else
-                offset += getSize(type);
-        }
+                entry.chunk.emplace_back(offset, get<std::span<const int32_t>>(value));
+        };
 
-        if (bitCounter > 0) *reinterpret_cast<uint32_t*>(new_data.data() + offset) = currentBool.to_ulong();
+        writeEXPA(entry.data.data(), count, getValue, addChunk);
+        return entry;
+    }
 
-        return {.data = new_data, .chunk = chunkEntries};
+    auto Structure::writeEXPA(const std::vector<EntryValue>& entries) const -> EXPAEntry
+    {
+        return writeEXPA(std::min(fields.size(), entries.size()), [&](size_t i) { return toView(entries[i]); });
     }
 
     auto Structure::readEXPA(const char* data) const -> std::vector<EntryValue>
     {
-        if (structure.empty()) return {};
-
         std::vector<EntryValue> values;
-        auto offset     = 0u;
-        auto bitCounter = 0u;
-
-        for (const auto& val : structure)
-        {
-            if (val.type != EntryType::BOOL || bitCounter >= 32)
-            {
-                if (bitCounter > 0) offset += getSize(EntryType::BOOL);
-
-                offset     = ceilInteger(offset, getAlignment(val.type));
-                bitCounter = 0;
-            }
+        values.reserve(fields.size());
 
-            values.push_back(readEXPAEntry(val.type, data + offset, bitCounter));
-
-            if (val.type == EntryType::BOOL)
-                bitCounter++;
-            else
-                offset += getSize(val.type);
-        }
+        for (const auto& field : fields)
+            values.push_back(readEXPAEntry(field.type, data + field.offset, field.bit));
 
         return values;
     }
 
     auto Structure::readCSV(const std::vector<std::string>& data) const -> std::vector<EntryValue>
     {
-        return std::views::zip_transform([](const auto& val, const auto& val2) { return getCSVValue(val.type, val2); },
-                                         structure,
-                                         data) |
-               std::ranges::to<std::vector<EntryValue>>();
+        std::vector<std::string_view> fields(data.begin(), data.end());
+
+        auto result = readCSV(fields);
+        if (!result) throw std::invalid_argument(result.error());
+        return result.value();
+    }
+
+    auto Structure::readCSV(std::span<const std::string_view> data) const
+        -> std::expected<std::vector<EntryValue>, std::string>
+    {
+        auto count = std::min(structure.size(), data.size());
+
+        std::vector<EntryValue> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            auto type  = structure[i].type;
+            auto value = getCSVValue(type, data[i]);
+            if (!value) return std::unexpected(getInvalidValueError(type, data[i], i));
+            result.push_back(std::move(value.value()));
+        }
+
+        return result;
     }
 
     auto Structure::getCSVHeader() const -> std::string
@@ -291,37 +617,24 @@ namespace mvgltools::expa
 
     auto Structure::writeCSV(const std::vector<EntryValue>& entries) const -> std::string
     {
-        std::stringstream stream;
-        auto result = structure | std::views::transform([](const auto& val) { return val.name; }) |
-                      std::views::join_with(',') | std::ranges::to<std::string>();
-        stream << result << "\n";
-
-        return std::views::zip_transform([](const auto& val, const auto& val2) { return getCSVString(val.type, val2); },
-                                         structure,
-                                         entries) |
-               std::views::join_with(',') | std::ranges::to<std::string>();
+        std::string result;
+        writeCSV(entries, result);
+        return result;
     }
 
-    auto Structure::getEXPASize() const -> uint32_t
+    void Structure::writeCSV(const std::vector<EntryValue>& entries, std::string& buffer) const
     {
-        if (structure.empty()) return 0;
-
-        auto currentSize = 0u;
-        auto bitCounter  = 0u;
-
-        for (const auto& val : structure)
+        auto count = std::min(structure.size(), entries.size());
+        for (size_t i = 0; i < count; i++)
         {
-            if (bitCounter == 0 || bitCounter >= 32 || val.type != EntryType::BOOL)
-            {
-                currentSize = ceilInteger(currentSize, getAlignment(val.type));
-                bitCounter  = 0;
-            }
-
-            if (bitCounter == 0) currentSize += getSize(val.type);
-            if (val.type == EntryType::BOOL) bitCounter++;
+            if (i != 0) buffer += ',';
+            appendCSVValue(buffer, structure[i].type, toView(entries[i]));
         }
+    }
 
-        return ceilInteger(currentSize, 8);
+    auto Structure::getEXPASize() const -> uint32_t
+    {
+        return expaSize;
     }
 
     auto Structure::getEntryCount() const -> size_t
@@ -329,41 +642,791 @@ namespace mvgltools::expa
         return structure.size();
     }
 
-    CHNKEntry::CHNKEntry(uint32_t offset, const std::string& data)
+    CHNKEntry::CHNKEntry(uint32_t offset, std::string_view data)
         : offset(offset)
     {
         value = std::vector<char>(ceilInteger(static_cast<int64_t>(data.size() + 2), 4));
         std::ranges::copy(data, value.begin());
     }
 
-    CHNKEntry::CHNKEntry(uint32_t offset, const std::vector<int32_t>& data)
+    CHNKEntry::CHNKEntry(uint32_t offset, std::span<const int32_t> data)
         : offset(offset)
     {
         value = std::vector<char>(data.size() * sizeof(int32_t));
         std::copy_n(reinterpret_cast<const char*>(data.data()), value.size(), value.begin());
     }
 
-    auto exportCSV(const TableFile& file, const std::filesystem::path& target) -> std::expected<void, std::string>
+    CHNKIndex::CHNKIndex(std::span<const char> buffer, uint64_t sectionOffset, uint32_t entryCount)
+        : buffer(buffer)
+        , sectionOffset(sectionOffset)
+        , entryCount(entryCount)
     {
-        if (std::filesystem::exists(target) && !std::filesystem::is_directory(target))
-            return std::unexpected("Target path exists and is not a directory.");
+    }
 
-        std::filesystem::create_directories(target);
+    auto CHNKIndex::load() -> std::expected<void, std::string>
+    {
+        std::call_once(loaded, [this] { status = readEntries(); });
+        return status;
+    }
 
-        int32_t table_id = 0;
-        for (const auto& table : file.tables)
-        {
-            auto path = target / std::format("{:03}_{}.csv", table_id++, table.name);
-            std::ofstream stream(path, std::ios::out);
+    auto CHNKIndex::readEntries() -> std::expected<void, std::string>
+    {
+        const MemorySource source(buffer);
+        ByteReader stream(source, sectionOffset);
 
-            if (!stream) return std::unexpected("Failed to write target file.");
+        entries.reserve(entryCount);
+        for (uint32_t i = 0; i < entryCount; i++)
+        {
+            auto offset = read<uint32_t>(stream);
+            auto size   = read<uint32_t>(stream);
+            auto start  = stream.tellg();
+            if (!stream || start > buffer.size() || size > buffer.size() - start)
+                return std::unexpected(std::format("CHNK entry {} exceeds the file.", i));
+            if (offset > buffer.size() - sizeof(uint64_t))
+                return std::unexpected(std::format("CHNK entry {} points outside of the file.", i));
 
-            stream << table.structure.getCSVHeader() << "\n";
-            std::ranges::for_each(table.entries,
-                                  [&](const auto& val) { stream << table.structure.writeCSV(val) << "\n"; });
+            entries.emplace_back(offset, buffer.subspan(start, size));
+            stream.seekg(size, std::ios::cur);
         }
 
+        // written files are already sorted, a later entry for the same pointer replaces an earlier one
+        if (!std::ranges::is_sorted(entries, {}, &CHNKSlice::offset))
+            std::ranges::stable_sort(entries, {}, &CHNKSlice::offset);
+
         return {};
     }
 
-} // namespace mvgltools::expa
+    auto CHNKIndex::find(uint64_t offset) const -> std::span<const char>
+    {
+        auto itr = std::ranges::upper_bound(entries, offset, {}, &CHNKSlice::offset);
+        if (itr == entries.begin() || std::prev(itr)->offset != offset) return {};
+        return std::prev(itr)->value;
+    }
+
+    TableView::TableView(std::string_view name,
+                         Structure structure,
+                         std::span<const char> buffer,
+                         uint64_t dataOffset,
+                         uint32_t entryCount,
+                         uint32_t entrySize,
+                         std::shared_ptr<CHNKIndex> chunks)
+        : name(name)
+        , structure(std::move(structure))
+        , buffer(buffer)
+        , dataOffset(dataOffset)
+        , entryCount(entryCount)
+        , entrySize(ceilInteger(entrySize, 8))
+        , chunks(std::move(chunks))
+        , validation(std::make_shared<Validation>())
+    {
+    }
+
+    auto TableView::getChunk(uint64_t offset) const -> std::span<const char>
+    {
+        return chunks->find(offset);
+    }
+
+    auto TableView::getName() const -> std::string_view
+    {
+        return name;
+    }
+
+    auto TableView::getStructure() const -> const Structure&
+    {
+        return structure;
+    }
+
+    auto TableView::getEntryCount() const -> size_t
+    {
+        return entryCount;
+    }
+
+    auto TableView::getValue(size_t row, size_t column) const -> EntryValueView
+    {
+        const auto& field = structure.fields[column];
+        auto offset       = dataOffset + (row * entrySize) + field.offset;
+        const auto* data  = buffer.data() + offset;
+
+        switch (field.type)
+        {
+            default:
+            case EntryType::UNK1: [[fallthrough]];
+            case EntryType::EMPTY: return std::nullopt;
+
+            case EntryType::INT32: return *reinterpret_cast<const int32_t*>(data);
+            case EntryType::INT16: return *reinterpret_cast<const int16_t*>(data);
+            case EntryType::INT8: return *reinterpret_cast<const int8_t*>(data);
+            case EntryType::FLOAT: return *reinterpret_cast<const float*>(data);
+            case EntryType::STRING3: [[fallthrough]];
+            case EntryType::STRING: [[fallthrough]];
+            case EntryType::STRING2:
+            {
+                auto chunk = getChunk(offset);
+                const std::string_view value(chunk.data(), chunk.size());
+                return value.substr(0, value.find('\0'));
+            }
+            case EntryType::BOOL: return ((*reinterpret_cast<const uint32_t*>(data) >> field.bit) & 1u) == 1u;
+            case EntryType::INT32_ARRAY:
+            {
+                auto count = *reinterpret_cast<const int32_t*>(data);
+                if (count <= 0) return std::span<const int32_t>{};
+
+                // checked by validate
+                auto chunk = getChunk(offset + 8);
+                return std::span(reinterpret_cast<const int32_t*>(chunk.data()), count);
+            }
+        }
+    }
+
+    auto TableView::validate() const -> std::expected<void, std::string>
+    {
+        std::call_once(validation->done,
+                       [this]
+                       {
+                           validation->result = chunks->load();
+                           if (validation->result) validation->result = checkArrays();
+                       });
+        return validation->result;
+    }
+
+    auto TableView::checkArrays() const -> std::expected<void, std::string>
+    {
+        for (size_t column = 0; column < structure.fields.size(); column++)
+        {
+            const auto& field = structure.fields[column];
+            if (field.type != EntryType::INT32_ARRAY) continue;
+
+            for (size_t row = 0; row < entryCount; row++)
+            {
+                auto offset = dataOffset + (row * entrySize) + field.offset;
+                auto count  = *reinterpret_cast<const int32_t*>(buffer.data() + offset);
+                if (count <= 0) continue;
+
+                auto chunk = getChunk(offset + 8);
+                if (chunk.size() < count * sizeof(int32_t) ||
+                    reinterpret_cast<uintptr_t>(chunk.data()) % alignof(int32_t) != 0)
+                    return std::unexpected(std::format(
+                        "Array in row {} column {} of table {} exceeds its CHNK entry.", row, column, name));
+            }
+        }
+
+        return {};
+    }
+
+    auto TableView::getRow(size_t row) const -> std::vector<EntryValue>
+    {
+        std::vector<EntryValue> values;
+        values.reserve(structure.fields.size());
+        for (size_t column = 0; column < structure.fields.size(); column++)
+            values.push_back(toValue(getValue(row, column)));
+
+        return values;
+    }
+
+    auto TableView::getRows(size_t first, size_t count) const -> std::vector<std::vector<EntryValue>>
+    {
+        if (first >= entryCount) return {};
+        const auto last = first + std::min<size_t>(count, entryCount - first);
+
+        std::vector<std::vector<EntryValue>> rows;
+        rows.reserve(last - first);
+        for (auto row = first; row < last; row++)
+            rows.push_back(getRow(row));
+
+        return rows;
+    }
+
+    auto TableView::begin() const -> RowIterator
+    {
+        return {*this, 0};
+    }
+
+    auto TableView::end() const -> std::default_sentinel_t
+    {
+        return std::default_sentinel;
+    }
+
+    TableView::RowIterator::RowIterator(const TableView& table, size_t row)
+        : table(&table)
+        , row(row)
+    {
+        decode();
+    }
+
+    void TableView::RowIterator::decode()
+    {
+        values.resize(table->structure.fields.size());
+        if (row >= table->entryCount) return;
+
+        for (size_t column = 0; column < values.size(); column++)
+            values[column] = table->getValue(row, column);
+    }
+
+    auto TableView::RowIterator::operator*() const -> value_type
+    {
+        return values;
+    }
+
+    auto TableView::RowIterator::operator++() -> RowIterator&
+    {
+        row++;
+        decode();
+        return *this;
+    }
+
+    void TableView::RowIterator::operator++(int)
+    {
+        ++*this;
+    }
+
+    auto TableView::RowIterator::operator==(std::default_sentinel_t /*unused*/) const -> bool
+    {
+        return table == nullptr || row >= table->entryCount;
+    }
+
+    auto TableView::RowIterator::getRow() const -> size_t
+    {
+        return row;
+    }
+
+    auto TableView::toTable() const -> Table
+    {
+        return {.name = std::string(name), .structure = structure, .entries = getRows(0, entryCount)};
+    }
+
+    auto TableView::toColumnarTable() const -> ColumnarTable
+    {
+        ColumnarTable table(std::string(name), structure);
+
+        std::vector<EntryValueView> entry;
+        for (const auto& row : *this)
+        {
+            entry.assign(row.begin(), row.end());
+            table.addEntry(entry);
+        }
+
+        return table;
+    }
+
+    TableFileView::TableFileView(std::vector<TableView> tables)
+        : tables(std::move(tables))
+    {
+    }
+
+    auto TableFileView::getTableCount() const -> size_t
+    {
+        return tables.size();
+    }
+
+    auto TableFileView::getTableName(size_t index) const -> std::string_view
+    {
+        return tables[index].getName();
+    }
+
+    auto TableFileView::getTableStructure(size_t index) const -> const Structure&
+    {
+        return tables[index].getStructure();
+    }
+
+    auto TableFileView::findTable(std::string_view name) const -> std::optional<size_t>
+    {
+        auto itr = std::ranges::find(tables, name, &TableView::getName);
+        if (itr == tables.end()) return std::nullopt;
+        return std::distance(tables.begin(), itr);
+    }
+
+    auto TableFileView::getTable(size_t index) const
+        -> std::expected<std::reference_wrapper<const TableView>, std::string>
+    {
+        if (index >= tables.size()) return std::unexpected(std::format("Table {} does not exist.", index));
+
+        const auto& table = tables[index];
+        auto valid        = table.validate();
+        if (!valid) return std::unexpected(valid.error());
+
+        return std::cref(table);
+    }
+
+    auto TableFileView::toTableFile() const -> std::expected<TableFile, std::string>
+    {
+        TableFile file;
+        for (const auto& table : tables)
+        {
+            auto valid = table.validate();
+            if (!valid) return std::unexpected(valid.error());
+            file.tables.push_back(table.toTable());
+        }
+
+        return file;
+    }
+
+    auto TableFileView::toColumnarTableFile() const -> std::expected<ColumnarTableFile, std::string>
+    {
+        ColumnarTableFile file;
+        for (const auto& table : tables)
+        {
+            auto valid = table.validate();
+            if (!valid) return std::unexpected(valid.error());
+            file.tables.push_back(table.toColumnarTable());
+        }
+
+        return file;
+    }
+
+    auto exportCSV(const TableFile& file, const std::filesystem::path& target) -> std::expected<void, std::string>
+    {
+        return exportCSVTables(file.tables, target);
+    }
+
+    auto exportCSV(const ColumnarTableFile& file, const std::filesystem::path& target)
+        -> std::expected<void, std::string>
+    {
+        return exportCSVTables(file.tables, target);
+    }
+
+    ColumnarTable::ColumnarTable(std::string name, Structure structure)
+        : name(std::move(name))
+        , structure(std::move(structure))
+    {
+        for (const auto& field : this->structure.fields)
+            columns.emplace_back(field.type);
+    }
+
+    ColumnarTable::ColumnarTable(const Table& table)
+        : ColumnarTable(table.name, table.structure)
+    {
+        for (const auto& entry : table.entries)
+            addEntry(entry);
+    }
+
+    auto ColumnarTable::getName() const -> const std::string&
+    {
+        return name;
+    }
+
+    auto ColumnarTable::getStructure() const -> const Structure&
+    {
+        return structure;
+    }
+
+    auto ColumnarTable::getEntryCount() const -> size_t
+    {
+        return entryCount;
+    }
+
+    auto ColumnarTable::getValue(size_t row, size_t column) const -> EntryValueView
+    {
+        const auto& col = columns[column];
+        switch (col.type)
+        {
+            default:
+            case EntryType::UNK1: [[fallthrough]];
+            case EntryType::EMPTY: return std::nullopt;
+
+            case EntryType::INT32: return getColumn<int32_t>(column)[row];
+            case EntryType::INT16: return getColumn<int16_t>(column)[row];
+            case EntryType::INT8: return getColumn<int8_t>(column)[row];
+            case EntryType::FLOAT: return getColumn<float>(column)[row];
+            case EntryType::BOOL: return ((col.bits[row / 64] >> (row % 64)) & 1U) == 1U;
+            case EntryType::STRING3: [[fallthrough]];
+            case EntryType::STRING: [[fallthrough]];
+            case EntryType::STRING2:
+                return std::string_view(col.text).substr(col.offsets[row], col.offsets[row + 1] - col.offsets[row]);
+            case EntryType::INT32_ARRAY:
+                return std::span(col.array).subspan(col.offsets[row], col.offsets[row + 1] - col.offsets[row]);
+        }
+    }
+
+    void ColumnarTable::addValue(Column& column, const EntryValueView& value)
+    {
+        switch (column.type)
+        {
+            case EntryType::INT32: appendValue(column.values, std::get<int32_t>(value)); break;
+            case EntryType::INT16: appendValue(column.values, std::get<int16_t>(value)); break;
+            case EntryType::INT8: appendValue(column.values, std::get<int8_t>(value)); break;
+            case EntryType::FLOAT: appendValue(column.values, std::get<float>(value)); break;
+            case EntryType::BOOL:
+                if (entryCount % 64 == 0) column.bits.push_back(0);
+                column.bits.back() |= static_cast<uint64_t>(std::get<bool>(value)) << (entryCount % 64);
+                break;
+            case EntryType::STRING3: [[fallthrough]];
+            case EntryType::STRING: [[fallthrough]];
+            case EntryType::STRING2:
+                column.text.append(std::get<std::string_view>(value));
+                column.offsets.push_back(column.text.size());
+                break;
+            case EntryType::INT32_ARRAY:
+            {
+                auto array = std::get<std::span<const int32_t>>(value);
+                column.array.insert(column.array.end(), array.begin(), array.end());
+                column.offsets.push_back(column.array.size());
+                break;
+            }
+
+            case EntryType::EMPTY: [[fallthrough]];
+            case EntryType::UNK1: [[fallthrough]];
+            default: break;
+        }
+    }
+
+    void ColumnarTable::addEntry(const std::vector<EntryValueView>& entry)
+    {
+        for (size_t i = 0; i < columns.size(); i++)
+            addValue(columns[i], i < entry.size() ? entry[i] : getDefaultValue(columns[i].type));
+        entryCount++;
+    }
+
+    void ColumnarTable::addEntry(const std::vector<EntryValue>& entry)
+    {
+        for (size_t i = 0; i < columns.size(); i++)
+            addValue(columns[i], i < entry.size() ? toView(entry[i]) : getDefaultValue(columns[i].type));
+        entryCount++;
+    }
+
+    auto ColumnarTable::writeEXPA(size_t row) const -> EXPAEntry
+    {
+        return structure.writeEXPA(columns.size(), [&](size_t i) { return getValue(row, i); });
+    }
+
+    auto ColumnarTable::writeCSV(size_t row) const -> std::string
+    {
+        std::string result;
+        writeCSV(row, result);
+        return result;
+    }
+
+    void ColumnarTable::writeCSV(size_t row, std::string& buffer) const
+    {
+        for (size_t i = 0; i < columns.size(); i++)
+        {
+            if (i != 0) buffer += ',';
+            appendCSVValue(buffer, columns[i].type, getValue(row, i));
+        }
+    }
+
+    auto ColumnarTable::readCSV(std::span<const std::string_view> data) -> std::expected<void, std::string>
+    {
+        for (size_t i = 0; i < columns.size(); i++)
+        {
+            auto& column = columns[i];
+            if (i >= data.size())
+            {
+                addValue(column, getDefaultValue(column.type));
+                continue;
+            }
+
+            auto value = data[i];
+            auto valid = true;
+            switch (column.type)
+            {
+                case EntryType::INT32:
+                case EntryType::INT16:
+                case EntryType::INT8:
+                {
+                    auto number = parseCSVNumber<int32_t>(value);
+                    valid       = number.has_value();
+                    if (!valid) break;
+
+                    if (column.type == EntryType::INT32) appendValue(column.values, number.value());
+                    if (column.type == EntryType::INT16) appendValue(column.values, static_cast<int16_t>(*number));
+                    if (column.type == EntryType::INT8) appendValue(column.values, static_cast<int8_t>(*number));
+                    break;
+                }
+                case EntryType::FLOAT:
+                {
+                    auto number = parseCSVNumber<float>(value);
+                    valid       = number.has_value();
+                    if (valid) appendValue(column.values, number.value());
+                    break;
+                }
+                case EntryType::INT32_ARRAY:
+                    valid = parseCSVArray(value, column.array);
+                    column.offsets.push_back(column.array.size());
+                    break;
+                case EntryType::BOOL: addValue(column, value == "true"); break;
+                case EntryType::STRING3: [[fallthrough]];
+                case EntryType::STRING: [[fallthrough]];
+                case EntryType::STRING2: addValue(column, value); break;
+                default: break;
+            }
+
+            if (valid) continue;
+
+            discardRow();
+            return std::unexpected(getInvalidValueError(column.type, value, i));
+        }
+
+        entryCount++;
+        return {};
+    }
+
+    void ColumnarTable::discardRow()
+    {
+        for (auto& column : columns)
+        {
+            switch (column.type)
+            {
+                case EntryType::INT32:
+                case EntryType::INT16:
+                case EntryType::INT8:
+                case EntryType::FLOAT: column.values.resize(entryCount * getSize(column.type)); break;
+                case EntryType::BOOL:
+                    column.bits.resize((entryCount + 63) / 64);
+                    if (entryCount % 64 != 0) column.bits.back() &= (uint64_t{1} << (entryCount % 64)) - 1;
+                    break;
+                case EntryType::STRING3: [[fallthrough]];
+                case EntryType::STRING: [[fallthrough]];
+                case EntryType::STRING2:
+                    column.offsets.resize(entryCount + 1);
+                    column.text.resize(column.offsets.back());
+                    break;
+                case EntryType::INT32_ARRAY:
+                    column.offsets.resize(entryCount + 1);
+                    column.array.resize(column.offsets.back());
+                    break;
+                default: break;
+            }
+        }
+    }
+
+    auto ColumnarTable::toTable() const -> Table
+    {
+        std::vector<std::vector<EntryValue>> entries(entryCount);
+        for (size_t row = 0; row < entryCount; row++)
+        {
+            entries[row].reserve(columns.size());
+            for (size_t column = 0; column < columns.size(); column++)
+                entries[row].push_back(toValue(getValue(row, column)));
+        }
+
+        return {.name = name, .structure = structure, .entries = std::move(entries)};
+    }
+
+} // namespace mvgltools::expa
+
+namespace mvgltools::expa::detail
+{
+    template<typename TableType>
+    auto EXPAWriter::encodeTables(const std::vector<TableType>& tables, bool hasStructureSection) -> std::vector<char>
+    {
+        // small enough to balance the load between threads, large enough to keep the per block overhead irrelevant
+        constexpr size_t BLOCK_ROWS = 1024;
+
+        struct Block
+        {
+            const TableType* table;
+            size_t firstRow;
+            size_t rowCount;
+            uint64_t rowOffset;
+            uint64_t chunkOffset{0};
+            uint64_t chunkSize{0};
+            uint32_t chunkCount{0};
+        };
+
+        // pass one, plan the table headers and rows...
+        std::vector<uint64_t> tableOffsets;
+        std::vector<Block> blocks;
+        uint64_t position = sizeof(EXPAHeader);
+
+        for (const auto& table : tables)
+        {
+            const auto& structure = getTableStructure(table);
+            const auto entryCount = getTableEntryCount(table);
+
+            tableOffsets.push_back(position);
+            position += sizeof(int32_t) + ceilInteger(static_cast<int64_t>(getTableName(table).size() + 1), 4);
+            if (hasStructureSection) position += sizeof(uint32_t) + structure.getEntryCount() * sizeof(EntryType);
+            position = ceilInteger(static_cast<int64_t>(position + 2 * sizeof(uint32_t)), 8);
+
+            for (size_t row = 0; row < entryCount; row += BLOCK_ROWS)
+            {
+                const auto rowCount = std::min(BLOCK_ROWS, entryCount - row);
+                blocks.push_back({.table = &table, .firstRow = row, .rowCount = rowCount, .rowOffset = position});
+                position += rowCount * structure.expaSize;
+            }
+        }
+
+        // ...then measure the CHNK entries of every block
+        auto measureBlock = [&](size_t index)
+        {
+            auto& block           = blocks[index];
+            const auto& structure = getTableStructure(*block.table);
+
+            for (auto row = block.firstRow; row < block.firstRow + block.rowCount; row++)
+            {
+                const auto length = getRowLength(*block.table, row);
+                for (size_t i = 0; i < length; i++)
+                {
+                    if (!hasChunk(structure.fields[i].type)) continue;
+
+                    const auto size = getChunkSize(getRowValue(*block.table, row, i));
+                    if (size == 0) continue;
+
+                    block.chunkSize += 2 * sizeof(uint32_t) + size;
+                    block.chunkCount++;
+                }
+            }
+        };
+        parallelFor(blocks.size(), measureBlock);
+
+        const auto chunkHeaderOffset = position;
+        position += sizeof(CHNKHeader);
+
+        uint32_t chunkCount = 0;
+        for (auto& block : blocks)
+        {
+            block.chunkOffset  = position;
+            position          += block.chunkSize;
+            chunkCount        += block.chunkCount;
+        }
+
+        // pass two, everything not written explicitly is alignment padding and stays zero
+        std::vector<char> buffer(position);
+        writeData(buffer.data(), EXPAHeader{.tableCount = static_cast<int32_t>(tables.size())});
+        writeData(buffer.data() + chunkHeaderOffset, CHNKHeader{.numEntry = chunkCount});
+
+        for (size_t i = 0; i < tables.size(); i++)
+        {
+            const auto& name      = getTableName(tables[i]);
+            const auto& structure = getTableStructure(tables[i]);
+            const auto nameSize   = ceilInteger(static_cast<int64_t>(name.size() + 1), 4);
+
+            auto* cursor = writeData(buffer.data() + tableOffsets[i], static_cast<int32_t>(nameSize));
+            std::ranges::copy(name, cursor);
+            cursor += nameSize;
+
+            if (hasStructureSection)
+            {
+                cursor = writeData(cursor, static_cast<uint32_t>(structure.getEntryCount()));
+                for (const auto& entry : structure.structure)
+                    cursor = writeData(cursor, entry.type);
+            }
+
+            cursor = writeData(cursor, structure.expaSize);
+            writeData(cursor, static_cast<uint32_t>(getTableEntryCount(tables[i])));
+        }
+
+        auto encodeBlock = [&](size_t index)
+        {
+            const auto& block     = blocks[index];
+            const auto& structure = getTableStructure(*block.table);
+            auto* chunk           = buffer.data() + block.chunkOffset;
+
+            for (size_t i = 0; i < block.rowCount; i++)
+            {
+                const auto row       = block.firstRow + i;
+                const auto rowOffset = block.rowOffset + i * structure.expaSize;
+
+                auto getValue = [&](size_t column) { return getRowValue(*block.table, row, column); };
+                auto addChunk = [&](uint32_t offset, const EntryValueView& value)
+                { chunk = writeChunkEntry(chunk, static_cast<uint32_t>(rowOffset + offset), value); };
+
+                structure.writeEXPA(buffer.data() + rowOffset, getRowLength(*block.table, row), getValue, addChunk);
+            }
+        };
+        parallelFor(blocks.size(), encodeBlock);
+
+        return buffer;
+    }
+
+    auto EXPAWriter::encode(const std::vector<Table>& tables, bool hasStructureSection) -> std::vector<char>
+    {
+        return encodeTables(tables, hasStructureSection);
+    }
+
+    auto EXPAWriter::encode(const std::vector<ColumnarTable>& tables, bool hasStructureSection) -> std::vector<char>
+    {
+        return encodeTables(tables, hasStructureSection);
+    }
+
+} // namespace mvgltools::expa::detail
+
+namespace mvgltools::expa::detail
+{
+    CSVReader::CSVReader(const std::filesystem::path& path)
+        : source(path)
+        , position(source.data().data())
+        , end(source.data().data() + source.data().size())
+    {
+        if (end - position >= 3 && std::memcmp(position, "\xEF\xBB\xBF", 3) == 0) position += 3;
+        if (nextRow()) header.assign(row.begin(), row.end());
+    }
+
+    auto CSVReader::getHeader() const -> const std::vector<std::string>&
+    {
+        return header;
+    }
+
+    auto CSVReader::getRow() const -> std::span<const std::string_view>
+    {
+        return row;
+    }
+
+    auto CSVReader::nextRow() -> bool
+    {
+        row.clear();
+        copies.clear();
+
+        // empty lines, unless they are rows of a single column table with an empty value
+        if (header.size() != 1)
+            while (position != end && (*position == '\n' || *position == '\r'))
+                position++;
+        if (position == end) return false;
+
+        const auto* pos = position;
+        for (;;)
+        {
+            if (pos != end && *pos == '"')
+                pos = parseQuoted(pos + 1);
+            else
+            {
+                const auto* fieldEnd = findFieldEnd(pos, end);
+                row.emplace_back(pos, fieldEnd);
+                pos = fieldEnd;
+            }
+
+            if (pos == end || *pos != ',') break;
+            pos++;
+        }
+
+        if (pos != end && *pos == '\r' && pos + 1 != end && pos[1] == '\n') pos++;
+        if (pos != end) pos++;
+        position = pos;
+        return true;
+    }
+
+    auto CSVReader::parseQuoted(const char* pos) -> const char*
+    {
+        const auto* quote = findQuote(pos, end);
+        const auto* next  = quote == end ? end : quote + 1;
+
+        // the common case, a quoted field without escaped quotes
+        if (next == end || *next == ',' || *next == '\n' || *next == '\r')
+        {
+            row.emplace_back(pos, quote);
+            return next;
+        }
+
+        auto& copy = copies.emplace_back(pos, quote);
+        while (*next == '"')
+        {
+            copy += '"';
+            pos   = next + 1;
+            quote = findQuote(pos, end);
+            copy.append(pos, quote);
+
+            next = quote == end ? end : quote + 1;
+            if (next == end)
+            {
+                row.emplace_back(copy);
+                return end;
+            }
+        }
+
+        // text after the closing quote is kept, like in an unquoted field
+        const auto* fieldEnd = findFieldEnd(next, end);
+        copy.append(next, fieldEnd);
+        row.emplace_back(copy);
+        return fieldEnd;
+    }
+} // namespace mvgltools::expa::detail
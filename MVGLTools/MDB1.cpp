@@ -1,14 +1,23 @@
 
 #include "MDB1.h"
 
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree_fwd.hpp>
+
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <deque>
+#include <expected>
 #include <filesystem>
+#include <format>
+#include <fstream>
 #include <iterator>
+#include <map>
+#include <ranges>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -64,7 +73,44 @@ namespace
         return {.compareBit = INVALID, .left = INVALID, .right = 0, .name{}};
     }
 
-    inline auto buildMDB1Path(const std::filesystem::path& path) -> std::string
+    /**
+     * Adds the files of a manifest, a JSON object mapping the names within the archive to the files to pack.
+     * Relative file paths are resolved from the folder containing the manifest.
+     */
+    auto addManifestFiles(std::map<std::filesystem::path, TreeName>& files, const std::filesystem::path& manifest)
+        -> std::expected<void, std::string>
+    {
+        boost::property_tree::ptree tree;
+
+        try
+        {
+            boost::property_tree::read_json(manifest.string(), tree);
+        }
+        catch (const boost::property_tree::json_parser_error& ex)
+        {
+            return std::unexpected(std::format("Failed to read manifest {}: {}", manifest.string(), ex.what()));
+        }
+
+        for (const auto& [name, value] : tree)
+        {
+            auto relPath = name;
+            std::ranges::replace(relPath, '\\', '/');
+            auto path = manifest.parent_path() / value.data();
+
+            if (!std::filesystem::is_regular_file(path))
+                return std::unexpected(std::format(
+                    "File {} for {} in manifest {} does not exist.", path.string(), name, manifest.string()));
+
+            files[relPath] = TreeName{.name = buildMDB1Path(relPath), .path = path, .baseEntry = std::nullopt};
+        }
+
+        return {};
+    }
+} // namespace
+
+namespace mvgltools::mdb1::detail
+{
+    auto buildMDB1Path(const std::filesystem::path& path) -> std::string
     {
         auto extension = path.extension().string().substr(1, 5);
         auto tmp       = path;
@@ -81,13 +127,8 @@ namespace
         return name.data();
     }
 
-} // namespace
-
-namespace mvgltools::mdb1::detail
-{
-    // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-    auto generateTree(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& source)
-        -> std::vector<TreeNode>
+    auto getTreeNames(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& source)
+        -> std::vector<TreeName>
     {
         std::vector<TreeName> fileNames;
         std::ranges::transform(paths,
@@ -95,9 +136,155 @@ namespace mvgltools::mdb1::detail
                                [&](const auto& path)
                                {
                                    auto relPath = std::filesystem::relative(path, source);
-                                   return TreeName{buildMDB1Path(relPath), path};
+                                   return TreeName{.name = buildMDB1Path(relPath), .path = path, .baseEntry = {}};
                                });
 
+        return fileNames;
+    }
+
+    auto sortFiles(std::vector<const TreeName*>& order, const PackOptions& options) -> std::expected<void, std::string>
+    {
+        std::vector<std::pair<uint64_t, const TreeName*>> keyed;
+
+        switch (options.layout)
+        {
+            case DataLayout::TREE:
+            case DataLayout::PATH: return {};
+            case DataLayout::SIZE:
+            {
+                // the stored size isn't known before compressing, the size class of the input is close enough
+                std::ranges::transform(
+                    order,
+                    std::back_inserter(keyed),
+                    [](const TreeName* file)
+                    {
+                        auto size =
+                            file->baseEntry ? file->baseEntry->compressedSize : std::filesystem::file_size(file->path);
+                        return std::pair{static_cast<uint64_t>(std::bit_width(size)), file};
+                    });
+                break;
+            }
+            case DataLayout::ACCESS:
+            {
+                if (options.accessLog.empty()) return std::unexpected("The access layout requires an access log.");
+
+                std::ifstream input(options.accessLog);
+                if (!input)
+                    return std::unexpected(std::format("Failed to read access log {}.", options.accessLog.string()));
+
+                // name -> position of the first access
+                std::map<std::string, uint64_t> accesses;
+                std::string line;
+                while (std::getline(input, line))
+                {
+                    if (line.ends_with('\r')) line.pop_back();
+                    std::ranges::replace(line, '\\', '/');
+                    if (!std::filesystem::path(line).has_extension()) continue;
+
+                    accesses.emplace(buildMDB1Path(line), accesses.size());
+                }
+
+                // files that never get accessed come last
+                std::ranges::transform(order,
+                                       std::back_inserter(keyed),
+                                       [&](const TreeName* file)
+                                       {
+                                           auto itr  = accesses.find(file->name);
+                                           auto rank = itr == accesses.end() ? accesses.size() : itr->second;
+                                           return std::pair{rank, file};
+                                       });
+                break;
+            }
+        }
+
+        // stable, so files of the same key keep their order
+        std::ranges::stable_sort(keyed, {}, &std::pair<uint64_t, const TreeName*>::first);
+        std::ranges::transform(keyed, order.begin(), [](const auto& pair) { return pair.second; });
+        return {};
+    }
+
+    auto getVolumePath(const std::filesystem::path& target, size_t volume) -> std::filesystem::path
+    {
+        if (volume == 0) return target;
+
+        auto path = target;
+        path.replace_filename(std::format("{}.{}{}", target.stem().string(), volume, target.extension().string()));
+        return path;
+    }
+
+    auto isVolumeOf(const std::filesystem::path& file, const std::filesystem::path& target) -> bool
+    {
+        for (size_t volume = 0; std::filesystem::exists(getVolumePath(target, volume)); volume++)
+            if (file_equivalent(file, getVolumePath(target, volume))) return true;
+
+        return false;
+    }
+
+    void removeVolumes(const std::filesystem::path& target, size_t firstVolume)
+    {
+        for (auto volume = firstVolume; std::filesystem::exists(getVolumePath(target, volume)); volume++)
+            std::filesystem::remove(getVolumePath(target, volume));
+    }
+
+    auto collectFiles(const std::vector<const std::map<std::string, ArchiveEntry>*>& baseEntries,
+                      const std::vector<std::filesystem::path>& overlays)
+        -> std::expected<std::vector<TreeName>, std::string>
+    {
+        // keyed by the relative path, so the files are ordered like in a regular pack
+        std::map<std::filesystem::path, TreeName> files;
+
+        for (size_t i = 0; i < baseEntries.size(); i++)
+        {
+            for (const auto& [name, entry] : *baseEntries[i])
+            {
+                auto relPath = name;
+                std::ranges::replace(relPath, '\\', '/');
+                files[relPath] = TreeName{
+                    .name = buildMDB1Path(relPath), .path = {}, .baseEntry = entry, .baseArchive = i};
+            }
+        }
+
+        auto baseCount = files.size();
+
+        for (const auto& overlay : overlays)
+        {
+            if (std::filesystem::is_regular_file(overlay))
+            {
+                auto result = addManifestFiles(files, overlay);
+                if (!result) return std::unexpected(result.error());
+                continue;
+            }
+
+            if (!std::filesystem::is_directory(overlay))
+                return std::unexpected(
+                    std::format("Overlay path {} does not exist or is not a directory or manifest.", overlay.string()));
+
+            for (const auto& i : std::filesystem::recursive_directory_iterator(overlay))
+            {
+                if (!std::filesystem::is_regular_file(i)) continue;
+
+                auto relPath   = std::filesystem::relative(i, overlay);
+                files[relPath] = TreeName{.name = buildMDB1Path(relPath), .path = i.path(), .baseEntry = std::nullopt};
+            }
+        }
+
+        auto copied = std::ranges::count_if(files | std::views::values,
+                                            [](const auto& file) { return file.baseEntry.has_value(); });
+        if (baseCount == 0)
+            log(std::format("[Pack] {} files from {} sources.", files.size(), overlays.size()));
+        else
+            log(std::format("[Pack] {} files from {} base archives, {} replaced, {} added.",
+                            copied,
+                            baseEntries.size(),
+                            baseCount - copied,
+                            files.size() - baseCount));
+
+        return files | std::views::values | std::ranges::to<std::vector>();
+    }
+
+    // NOLINTNEXTLINE(readability-function-cognitive-complexity)
+    auto generateTree(std::vector<TreeName> fileNames) -> std::vector<TreeNode>
+    {
         struct QueueEntry
         {
             uint64_t parentNode;
@@ -109,7 +296,7 @@ namespace mvgltools::mdb1::detail
 
         std::vector<TreeNode> nodes  = {{.compareBit = INVALID, .left = 0, .right = 0, .name = {}}};
         std::deque<QueueEntry> queue = {
-            {.parentNode = 0, .compareBit = INVALID, .list = fileNames, .nodeList = {}, .isLeft = false}};
+            {.parentNode = 0, .compareBit = INVALID, .list = std::move(fileNames), .nodeList = {}, .isLeft = false}};
 
         while (!queue.empty())
         {
@@ -0,0 +1,33 @@
+#include "Parallel.h"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace
+{
+    auto getThreadPool() -> boost::asio::thread_pool&
+    {
+        static boost::asio::thread_pool pool(mvgltools::getThreadCount());
+        return pool;
+    }
+} // namespace
+
+namespace mvgltools
+{
+    auto getThreadCount() -> size_t
+    {
+        static const size_t count = std::max(std::thread::hardware_concurrency(), 1U);
+        return count;
+    }
+
+    void postTask(std::function<void()> task)
+    {
+        boost::asio::post(getThreadPool(), std::move(task));
+    }
+} // namespace mvgltools
@@ -1,4 +1,6 @@
 #pragma once
+#include "ByteSource.h"
+
 #include <filesystem>
 
 namespace mvgltools::afs2
@@ -8,6 +10,11 @@ namespace mvgltools::afs2
      */
     void extractAFS2(const std::filesystem::path& source, const std::filesystem::path& target);
 
+    /**
+     * Extracts the AFS2 archive read from source into targetPath, e.g. one stored within an MVGL archive.
+     */
+    void extractAFS2(const ByteSource& source, const std::filesystem::path& target);
+
     /**
      * Packs the folder given by sourcePath into an AFS2 archive saved into targetFile.
      */
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace boost::interprocess
+{
+    class mapped_region;
+} // namespace boost::interprocess
+
+namespace mvgltools
+{
+    /**
+     * Represents a readable range of bytes, e.g. a file, a buffer in memory or a file within an archive.
+     * Reads are positional and don't share a cursor, so a source can be read from multiple threads at once.
+     */
+    class ByteSource
+    {
+    public:
+        ByteSource()                                     = default;
+        ByteSource(const ByteSource&)                    = delete;
+        ByteSource(ByteSource&&)                         = delete;
+        auto operator=(const ByteSource&) -> ByteSource& = delete;
+        auto operator=(ByteSource&&) -> ByteSource&      = delete;
+        virtual ~ByteSource()                            = default;
+
+        /**
+         * Reads data.size() bytes starting at the given offset into data.
+         *
+         * @param offset the offset within the source to start reading at
+         * @param data the buffer to read into
+         * @return void if successful, an error string if the range exceeds the source or reading failed
+         */
+        virtual auto readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string> = 0;
+
+        /**
+         * Gets the size of the source in bytes.
+         */
+        [[nodiscard]] virtual auto size() const -> uint64_t = 0;
+
+        /**
+         * Reads count bytes starting at the given offset.
+         *
+         * @return the data if successful, an error string if the range exceeds the source or reading failed
+         */
+        [[nodiscard]] auto read(uint64_t offset, uint64_t count) const -> std::expected<std::vector<char>, std::string>;
+    };
+
+    /**
+     * A file on disk, read with positional reads (pread/ReadFile) without a shared cursor.
+     * If the file can't be opened, the source is empty and evaluates to false.
+     */
+    class FileSource : public ByteSource
+    {
+    public:
+        explicit FileSource(const std::filesystem::path& path);
+        FileSource(const FileSource&)                    = delete;
+        FileSource(FileSource&&)                         = delete;
+        auto operator=(const FileSource&) -> FileSource& = delete;
+        auto operator=(FileSource&&) -> FileSource&      = delete;
+        ~FileSource() override;
+
+        auto readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string> override;
+        [[nodiscard]] auto size() const -> uint64_t override;
+
+        explicit operator bool() const;
+
+    private:
+        std::filesystem::path path;
+        uint64_t fileSize = 0;
+#ifdef _WIN32
+        void* handle = nullptr;
+#else
+        int handle = -1;
+#endif
+    };
+
+    /**
+     * A file on disk, mapped into memory. Faster than a FileSource for many small reads.
+     * If the file can't be mapped, e.g. because it is empty, the source is empty and evaluates to false.
+     */
+    class MappedSource : public ByteSource
+    {
+    public:
+        explicit MappedSource(const std::filesystem::path& path);
+        MappedSource(const MappedSource&)                    = delete;
+        MappedSource(MappedSource&&)                         = delete;
+        auto operator=(const MappedSource&) -> MappedSource& = delete;
+        auto operator=(MappedSource&&) -> MappedSource&      = delete;
+        ~MappedSource() override;
+
+        auto readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string> override;
+        [[nodiscard]] auto size() const -> uint64_t override;
+
+        explicit operator bool() const;
+
+        /**
+         * Gets the mapped content of the file.
+         */
+        [[nodiscard]] auto data() const -> std::span<const char>;
+
+    private:
+        std::unique_ptr<boost::interprocess::mapped_region> region;
+    };
+
+    /**
+     * A buffer in memory, either owned by the source or a view of memory owned by the caller, which then has to
+     * outlive the source.
+     */
+    class MemorySource : public ByteSource
+    {
+    public:
+        explicit MemorySource(std::vector<char> buffer);
+        explicit MemorySource(std::span<const char> view);
+
+        auto readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string> override;
+        [[nodiscard]] auto size() const -> uint64_t override;
+
+        /**
+         * Gets the content of the buffer.
+         */
+        [[nodiscard]] auto data() const -> std::span<const char>;
+
+    private:
+        std::vector<char> buffer;
+        std::span<const char> view;
+    };
+
+    /**
+     * A range of another source, e.g. a file stored uncompressed within an archive.
+     */
+    class SubSource : public ByteSource
+    {
+    public:
+        SubSource(std::shared_ptr<const ByteSource> parent, uint64_t offset, uint64_t size);
+
+        auto readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string> override;
+        [[nodiscard]] auto size() const -> uint64_t override;
+
+    private:
+        std::shared_ptr<const ByteSource> parent;
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    /**
+     * A cursor over a source, for parsing formats front to back. Mimics the parts of std::istream the parsers use, so
+     * it works with the read helpers. A failed read puts it into a failed state, like a stream.
+     */
+    class ByteReader
+    {
+    public:
+        explicit ByteReader(const ByteSource& source, uint64_t position = 0);
+
+        auto read(char* data, uint64_t count) -> ByteReader&;
+        auto seekg(uint64_t newPosition) -> ByteReader&;
+        auto seekg(std::streamoff offset, std::ios::seekdir direction) -> ByteReader&;
+        [[nodiscard]] auto tellg() const -> uint64_t;
+
+        explicit operator bool() const;
+
+        /**
+         * Gets the error of the first failed read, if any.
+         */
+        [[nodiscard]] auto error() const -> const std::string&;
+
+    private:
+        const ByteSource& source;
+        uint64_t position;
+        std::string failure;
+    };
+} // namespace mvgltools
@@ -8,20 +8,31 @@
 
 namespace mvgltools
 {
+    /**
+     * Represents the available compression levels. All levels produce data the game can read, they only trade
+     * compression ratio for speed.
+     */
+    enum class CompressionLevel
+    {
+        FAST,
+        BALANCED,
+        BEST,
+    };
+
     /**
      * Represents the compressor interface, detailing all the static functions an implementation is required to have.
      */
     template<typename T>
-    concept Compressor = requires(const std::vector<char>& input, size_t size) {
+    concept Compressor = requires(const std::vector<char>& input, size_t size, CompressionLevel level) {
         /**
          * Decompresses the passed data. If the data isn't compressed or the passed size doesn't match the decompressed
          * size, the input data is returned.
          */
         { T::decompress(input, size) } -> std::same_as<std::expected<std::vector<char>, std::string>>;
         /**
-         * Compresses the passed data.
+         * Compresses the passed data with the given compression level.
          */
-        { T::compress(input) } -> std::same_as<std::expected<std::vector<char>, std::string>>;
+        { T::compress(input, level) } -> std::same_as<std::expected<std::vector<char>, std::string>>;
         /**
          * Returns whether the passed data is compressed using the algorithm.
          */
@@ -33,7 +44,8 @@ namespace mvgltools
     {
         static auto decompress(const std::vector<char>& input, size_t size)
             -> std::expected<std::vector<char>, std::string>;
-        static auto compress(const std::vector<char>& input) -> std::expected<std::vector<char>, std::string>;
+        static auto compress(const std::vector<char>& input, CompressionLevel level = CompressionLevel::BEST)
+            -> std::expected<std::vector<char>, std::string>;
         static auto isCompressed(const std::vector<char>& input) -> bool;
     };
 
@@ -42,7 +54,8 @@ namespace mvgltools
     {
         static auto decompress(const std::vector<char>& input, size_t size)
             -> std::expected<std::vector<char>, std::string>;
-        static auto compress(const std::vector<char>& input) -> std::expected<std::vector<char>, std::string>;
+        static auto compress(const std::vector<char>& input, CompressionLevel level = CompressionLevel::BEST)
+            -> std::expected<std::vector<char>, std::string>;
         static auto isCompressed(const std::vector<char>& input) -> bool;
     };
 } // namespace mvgltools
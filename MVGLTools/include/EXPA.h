@@ -1,38 +1,60 @@
 #pragma once
+#include "ByteSource.h"
 #include "Helpers.h"
+#include "Parallel.h"
 
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree_fwd.hpp>
 #include <boost/regex.hpp>
 #include <boost/regex/v5/regex_fwd.hpp>
 #include <boost/regex/v5/regex_search.hpp>
-#include <parser.hpp>
 
 #include <algorithm>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <expected>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <functional>
 #include <ios>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
+#include <shared_mutex>
+#include <span>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace mvgltools::expa
 {
+    namespace detail
+    {
+        class EXPAWriter;
+    }
+
     /**
      * Represents the value of an EXPA entry.
      */
     using EntryValue =
         std::variant<bool, int8_t, int16_t, int32_t, float, std::string, std::vector<int32_t>, std::nullopt_t>;
 
+    /**
+     * Represents the value of an EXPA entry, referencing the buffer it was read from instead of copying it.
+     */
+    using EntryValueView = std::
+        variant<bool, int8_t, int16_t, int32_t, float, std::string_view, std::span<const int32_t>, std::nullopt_t>;
+
     /**
      * Represents the available Entry types for EXPA tables
      */
@@ -59,8 +81,54 @@ namespace mvgltools::expa
         uint32_t offset;         // NOLINT(misc-non-private-member-variables-in-classes)
         std::vector<char> value; // NOLINT(misc-non-private-member-variables-in-classes)
 
-        CHNKEntry(uint32_t offset, const std::string& data);
-        CHNKEntry(uint32_t offset, const std::vector<int32_t>& data);
+        CHNKEntry(uint32_t offset, std::string_view data);
+        CHNKEntry(uint32_t offset, std::span<const int32_t> data);
+    };
+
+    /**
+     * Represents a CHNKEntry of an EXPA file that has been read, referencing the buffer it was read from.
+     */
+    struct CHNKSlice
+    {
+        uint32_t offset;
+        std::span<const char> value;
+    };
+
+    /**
+     * Represents the CHNK section of an EXPA file, referencing the buffer it was read from. The entries are indexed by
+     * their offset the first time the section is loaded.
+     */
+    class CHNKIndex
+    {
+    private:
+        std::span<const char> buffer;
+        uint64_t sectionOffset;
+        uint32_t entryCount;
+
+        std::once_flag loaded;
+        // sorted by offset
+        std::vector<CHNKSlice> entries;
+        std::expected<void, std::string> status;
+
+        auto readEntries() -> std::expected<void, std::string>;
+
+    public:
+        /**
+         * Constructs the index of a CHNK section, sectionOffset being the location of its first entry.
+         */
+        CHNKIndex(std::span<const char> buffer, uint64_t sectionOffset, uint32_t entryCount);
+
+        /**
+         * Indexes the entries on the first call, later calls return the result of the first one. Thread-safe.
+         *
+         * @return void if all entries lie within the buffer, an error string otherwise
+         */
+        auto load() -> std::expected<void, std::string>;
+
+        /**
+         * Get the value of the entry for a pointer, empty if there is none. The index must have been loaded.
+         */
+        [[nodiscard]] auto find(uint64_t offset) const -> std::span<const char>;
     };
 
     /**
@@ -87,8 +155,35 @@ namespace mvgltools::expa
      */
     class Structure
     {
+        friend class TableView;
+        friend class ColumnarTable;
+        friend class detail::EXPAWriter;
+
     private:
+        /**
+         * The location of a field within an EXPA row. Bools are packed into 32 bit words, they share the offset of
+         * their word and are identified by their bit.
+         */
+        struct Field
+        {
+            uint32_t offset;
+            EntryType type;
+            uint32_t bit;
+        };
+
         std::vector<StructureEntry> structure;
+        // the row layout, computed once so reading and writing rows doesn't have to
+        std::vector<Field> fields;
+        uint32_t expaSize{0};
+
+        // encodes the first count values of a row into data, getValue maps a column to its value and addChunk receives
+        // the offset within the row and the value of every string and array that is stored in the CHNK section
+        template<typename Getter, typename ChunkHandler>
+        void writeEXPA(char* data, size_t count, Getter getValue, ChunkHandler addChunk) const;
+
+        // encodes the first count values of a row, getValue maps a column to its value
+        template<typename Getter>
+        auto writeEXPA(size_t count, Getter getValue) const -> EXPAEntry;
 
     public:
         explicit Structure(std::vector<StructureEntry> structure);
@@ -128,10 +223,25 @@ namespace mvgltools::expa
          */
         [[nodiscard]] auto writeCSV(const std::vector<EntryValue>& entries) const -> std::string;
 
+        /**
+         * Append a vector of entry values, representing a row of this structure, as CSV to a buffer.
+         */
+        void writeCSV(const std::vector<EntryValue>& entries, std::string& buffer) const;
+
         /**
          * Convert a vector of strings into a vector of entry values, representing a row of this structure.
+         *
+         * @throws std::invalid_argument if a value doesn't match its type
          */
         [[nodiscard]] auto readCSV(const std::vector<std::string>& data) const -> std::vector<EntryValue>;
+
+        /**
+         * Convert a row of CSV fields into a vector of entry values, representing a row of this structure.
+         *
+         * @return the entry values if successful, an error string if a value doesn't match its type
+         */
+        [[nodiscard]] auto readCSV(std::span<const std::string_view> data) const
+            -> std::expected<std::vector<EntryValue>, std::string>;
     };
 
     /**
@@ -152,6 +262,271 @@ namespace mvgltools::expa
         std::vector<Table> tables;
     };
 
+    /**
+     * Represents a structured data table stored by column instead of by row. Each column is a contiguous array of its
+     * type, with bools packed into bits. Strings and int arrays of a column are stored back to back in one buffer,
+     * located by an offset per row. Uses a fraction of the memory of a Table and is faster to scan.
+     */
+    class ColumnarTable
+    {
+    private:
+        struct Column
+        {
+            EntryType type;
+            // INT8, INT16, INT32 and FLOAT values
+            std::vector<char> values;
+            // BOOL values, one bit per row
+            std::vector<uint64_t> bits;
+            // STRING and INT32_ARRAY values, row i is located at [offsets[i], offsets[i + 1])
+            std::vector<uint32_t> offsets{0};
+            std::string text;
+            std::vector<int32_t> array;
+        };
+
+        std::string name;
+        Structure structure;
+        std::vector<Column> columns;
+        size_t entryCount{0};
+
+        void addValue(Column& column, const EntryValueView& value);
+        // drops the values of a partially added row
+        void discardRow();
+
+    public:
+        ColumnarTable(std::string name, Structure structure);
+        explicit ColumnarTable(const Table& table);
+
+        [[nodiscard]] auto getName() const -> const std::string&;
+        [[nodiscard]] auto getStructure() const -> const Structure&;
+        [[nodiscard]] auto getEntryCount() const -> size_t;
+
+        /**
+         * Get all values of an INT8, INT16, INT32 or FLOAT column. T must match the type of the column.
+         */
+        template<typename T>
+        [[nodiscard]] auto getColumn(size_t column) const -> std::span<const T>
+        {
+            const auto& values = columns[column].values;
+            return {reinterpret_cast<const T*>(values.data()), values.size() / sizeof(T)};
+        }
+
+        /**
+         * Get a single value of the table. The caller must make sure row and column are within the table.
+         */
+        [[nodiscard]] auto getValue(size_t row, size_t column) const -> EntryValueView;
+
+        /**
+         * Append a row of entry values. The values must match the structure.
+         */
+        void addEntry(const std::vector<EntryValueView>& entry);
+
+        /**
+         * Append a row of entry values. The values must match the structure.
+         */
+        void addEntry(const std::vector<EntryValue>& entry);
+
+        /**
+         * Convert a row into an EXPAEntry.
+         */
+        [[nodiscard]] auto writeEXPA(size_t row) const -> EXPAEntry;
+
+        /**
+         * Convert a row into a CSV compatible string.
+         */
+        [[nodiscard]] auto writeCSV(size_t row) const -> std::string;
+
+        /**
+         * Append a row as CSV to a buffer.
+         */
+        void writeCSV(size_t row, std::string& buffer) const;
+
+        /**
+         * Parse a row of CSV fields and append it. Missing fields get a default value.
+         *
+         * @return void if successful, an error string if a value doesn't match its type. The row is not added then.
+         */
+        auto readCSV(std::span<const std::string_view> data) -> std::expected<void, std::string>;
+
+        /**
+         * Convert the table into a row based Table.
+         */
+        [[nodiscard]] auto toTable() const -> Table;
+    };
+
+    /**
+     * Represents a file of multiple tables stored by column.
+     */
+    struct ColumnarTableFile
+    {
+        std::vector<ColumnarTable> tables;
+    };
+
+    /**
+     * Represents a table of an EXPA file, referencing the buffer it was read from. Values are decoded when accessed,
+     * which requires the table to be validated first.
+     */
+    class TableView
+    {
+    private:
+        // the result of validate, shared by all copies of a view
+        struct Validation
+        {
+            std::once_flag done;
+            std::expected<void, std::string> result;
+        };
+
+        std::string_view name;
+        Structure structure;
+        std::span<const char> buffer;
+        uint64_t dataOffset;
+        uint32_t entryCount;
+        uint32_t entrySize;
+        // shared by all tables of a file
+        std::shared_ptr<CHNKIndex> chunks;
+        std::shared_ptr<Validation> validation;
+
+        [[nodiscard]] auto getChunk(uint64_t offset) const -> std::span<const char>;
+        [[nodiscard]] auto checkArrays() const -> std::expected<void, std::string>;
+
+    public:
+        /**
+         * Iterates the rows of a table, decoding one row at a time into views of its values. Keeps a single row in
+         * memory, no matter the size of the table.
+         */
+        class RowIterator
+        {
+        private:
+            const TableView* table{nullptr};
+            size_t row{0};
+            std::vector<EntryValueView> values;
+
+            void decode();
+
+        public:
+            using value_type      = std::span<const EntryValueView>;
+            using difference_type = std::ptrdiff_t;
+
+            RowIterator() = default;
+            RowIterator(const TableView& table, size_t row);
+
+            [[nodiscard]] auto operator*() const -> value_type;
+            auto operator++() -> RowIterator&;
+            void operator++(int);
+            [[nodiscard]] auto operator==(std::default_sentinel_t /*unused*/) const -> bool;
+
+            /**
+             * Get the index of the current row.
+             */
+            [[nodiscard]] auto getRow() const -> size_t;
+        };
+
+        /**
+         * Constructs a table from its location within the buffer. The rows must lie within the buffer.
+         */
+        TableView(std::string_view name,
+                  Structure structure,
+                  std::span<const char> buffer,
+                  uint64_t dataOffset,
+                  uint32_t entryCount,
+                  uint32_t entrySize,
+                  std::shared_ptr<CHNKIndex> chunks);
+
+        [[nodiscard]] auto getName() const -> std::string_view;
+        [[nodiscard]] auto getStructure() const -> const Structure&;
+        [[nodiscard]] auto getEntryCount() const -> size_t;
+
+        /**
+         * Loads the CHNK section of the file if that hasn't happened yet and checks that every array of the table lies
+         * within its CHNK entry. The check runs once, later calls return its result. Thread-safe.
+         *
+         * @return void if successful, an error string otherwise
+         */
+        [[nodiscard]] auto validate() const -> std::expected<void, std::string>;
+
+        /**
+         * Get a single value of the table. The caller must make sure row and column are within the table.
+         */
+        [[nodiscard]] auto getValue(size_t row, size_t column) const -> EntryValueView;
+
+        /**
+         * Decodes a single row, copying its values. The caller must make sure the row is within the table.
+         */
+        [[nodiscard]] auto getRow(size_t row) const -> std::vector<EntryValue>;
+
+        /**
+         * Decodes up to count rows starting at first, copying their values.
+         */
+        [[nodiscard]] auto getRows(size_t first, size_t count) const -> std::vector<std::vector<EntryValue>>;
+
+        /**
+         * Iterate the rows of the table, see RowIterator.
+         */
+        [[nodiscard]] auto begin() const -> RowIterator;
+        [[nodiscard]] auto end() const -> std::default_sentinel_t;
+
+        /**
+         * Decodes the table, copying all of its values.
+         */
+        [[nodiscard]] auto toTable() const -> Table;
+
+        /**
+         * Decodes the table into columns, copying all of its values.
+         */
+        [[nodiscard]] auto toColumnarTable() const -> ColumnarTable;
+    };
+
+    /**
+     * Represents an EXPA file, referencing the buffer it was read from, which has to outlive the view. Tables are
+     * validated on their first access, so looking at a single table only pays for that table.
+     */
+    class TableFileView
+    {
+    private:
+        std::vector<TableView> tables;
+
+    public:
+        explicit TableFileView(std::vector<TableView> tables);
+
+        [[nodiscard]] auto getTableCount() const -> size_t;
+
+        /**
+         * Get the name of a table from the table directory, without validating the table.
+         */
+        [[nodiscard]] auto getTableName(size_t index) const -> std::string_view;
+
+        /**
+         * Get the structure of a table from the table directory, without validating the table.
+         */
+        [[nodiscard]] auto getTableStructure(size_t index) const -> const Structure&;
+
+        /**
+         * Get the index of the first table with the given name.
+         */
+        [[nodiscard]] auto findTable(std::string_view name) const -> std::optional<size_t>;
+
+        /**
+         * Get a table of the file, validating it on the first access.
+         *
+         * @return the table if it is valid, an error string otherwise
+         */
+        [[nodiscard]] auto getTable(size_t index) const
+            -> std::expected<std::reference_wrapper<const TableView>, std::string>;
+
+        /**
+         * Decodes all tables, copying all of their values.
+         *
+         * @return the table file if all tables are valid, an error string otherwise
+         */
+        [[nodiscard]] auto toTableFile() const -> std::expected<TableFile, std::string>;
+
+        /**
+         * Decodes all tables into columns, copying all of their values.
+         *
+         * @return the table file if all tables are valid, an error string otherwise
+         */
+        [[nodiscard]] auto toColumnarTableFile() const -> std::expected<ColumnarTableFile, std::string>;
+    };
+
     /**
      * Represents an EXPA implementation, detailing all the data needed to use this module.
      */
@@ -205,6 +580,17 @@ namespace mvgltools::expa
     template<EXPA expa>
     auto writeEXPA(const TableFile& file, const std::filesystem::path& path) -> std::expected<void, std::string>;
 
+    /**
+     * Write a columnar table file as EXPA into the given path
+     *
+     * @param file the table file to write
+     * @param path the path to write to
+     * @return void if successful, an error string otherwise
+     */
+    template<EXPA expa>
+    auto writeEXPA(const ColumnarTableFile& file, const std::filesystem::path& path)
+        -> std::expected<void, std::string>;
+
     /**
      * Reads an EXPA file into a table file.
      *
@@ -214,6 +600,28 @@ namespace mvgltools::expa
     template<EXPA expa>
     auto readEXPA(const std::filesystem::path& path) -> std::expected<TableFile, std::string>;
 
+    /**
+     * Reads an EXPA file from a source into a table file, e.g. one stored within an MVGL archive.
+     *
+     * @param source the source to read from
+     * @param path the path of the file, used to look up the structure of its tables
+     * @return the table file if successful, an error string otherwise
+     */
+    template<EXPA expa>
+    auto readEXPA(const ByteSource& source, const std::filesystem::path& path) -> std::expected<TableFile, std::string>;
+
+    /**
+     * Parses an EXPA file held in memory, e.g. by a MappedSource, without copying its values. Only the header and
+     * table directory get read, the CHNK section is indexed and the tables validated when they are first accessed.
+     *
+     * @param buffer the content of the file, which has to outlive the returned view
+     * @param path the path of the file, used to look up the structure of its tables
+     * @return the view of the file if successful, an error string otherwise
+     */
+    template<EXPA expa>
+    auto readEXPAView(std::span<const char> buffer, const std::filesystem::path& path)
+        -> std::expected<TableFileView, std::string>;
+
     /**
      * Write a table file as CSV into the given path
      *
@@ -223,6 +631,16 @@ namespace mvgltools::expa
      */
     auto exportCSV(const TableFile& file, const std::filesystem::path& target) -> std::expected<void, std::string>;
 
+    /**
+     * Write a columnar table file as CSV into the given path
+     *
+     * @param file the table file to write
+     * @param path the path to write to
+     * @return void if successful, an error string otherwise
+     */
+    auto exportCSV(const ColumnarTableFile& file, const std::filesystem::path& target)
+        -> std::expected<void, std::string>;
+
     /**
      * Reads an CSV folder into a table file.
      *
@@ -231,6 +649,15 @@ namespace mvgltools::expa
      */
     template<EXPA expa>
     auto importCSV(const std::filesystem::path& source) -> std::expected<TableFile, std::string>;
+
+    /**
+     * Reads an CSV folder into a columnar table file.
+     *
+     * @param path the path to read from
+     * @return the table file if successful, an error string otherwise
+     */
+    template<EXPA expa>
+    auto importCSVColumnar(const std::filesystem::path& source) -> std::expected<ColumnarTableFile, std::string>;
 } // namespace mvgltools::expa
 
 namespace mvgltools::expa::detail
@@ -250,33 +677,41 @@ namespace mvgltools::expa::detail
         uint32_t numEntry{0};
     };
 
-    struct CSVFile
+    /**
+     * Reads a CSV file as described by RFC 4180 record by record from the mapped file. Fields are views into the file,
+     * only quoted fields with escaped quotes get copied. Accepts CRLF, LF and CR line breaks and skips a UTF-8 BOM.
+     * Empty lines are skipped, except in files with a single column, where they are rows with an empty value.
+     * If the file can't be read, it has no header and no rows.
+     */
+    class CSVReader
     {
     private:
+        MappedSource source;
+        const char* position{nullptr};
+        const char* end{nullptr};
         std::vector<std::string> header;
-        std::vector<std::vector<std::string>> rows;
+        std::vector<std::string_view> row;
+        // unescaped copies of the quoted fields of the current row, a deque so the views into it stay valid
+        std::deque<std::string> copies;
+
+        auto parseQuoted(const char* pos) -> const char*;
 
     public:
-        explicit CSVFile(const std::filesystem::path& path)
-        {
-            std::ifstream stream(path, std::ios::in);
-            aria::csv::CsvParser parser(stream);
+        explicit CSVReader(const std::filesystem::path& path);
 
-            for (const auto& row : parser)
-            {
-                std::vector<std::string> data;
-                for (const auto& field : row)
-                    data.push_back(field);
-
-                if (header.empty())
-                    header = data;
-                else
-                    rows.push_back(data);
-            }
-        }
+        [[nodiscard]] auto getHeader() const -> const std::vector<std::string>&;
+
+        /**
+         * Reads the next row. The fields of the previous row become invalid.
+         *
+         * @return true if a row was read, false at the end of the file
+         */
+        auto nextRow() -> bool;
 
-        [[nodiscard]] auto getHeader() const -> std::vector<std::string> { return header; }
-        [[nodiscard]] auto getRows() const -> std::vector<std::vector<std::string>> { return rows; }
+        /**
+         * Gets the fields of the current row.
+         */
+        [[nodiscard]] auto getRow() const -> std::span<const std::string_view>;
     };
 
     inline auto getTypeMap() -> std::map<std::string, EntryType>
@@ -308,10 +743,13 @@ namespace mvgltools::expa::detail
         return map.contains(val) ? map.at(val) : EntryType::EMPTY;
     }
 
-    inline auto getCSVStructure(const CSVFile& csv) -> std::vector<StructureEntry>
+    inline auto getCSVStructure(const CSVReader& csv) -> std::vector<StructureEntry>
     {
-        auto lambda = [](const auto& val)
-        { return StructureEntry{val, convertEntryType(val.substr(0, val.find_last_of(" ")))}; };
+        auto lambda = [](std::string_view val)
+        {
+            auto type = val.substr(0, val.find_last_of(' '));
+            return StructureEntry{std::string(val), convertEntryType(std::string(type))};
+        };
 
         return csv.getHeader() | std::views::transform(lambda) | std::ranges::to<std::vector<StructureEntry>>();
     }
@@ -335,57 +773,193 @@ namespace mvgltools::expa::detail
         }
     }
 
+    /**
+     * The structure definitions of an EXPA implementation, loaded from its STRUCTURE_FOLDER once per process.
+     * The file patterns are compiled on first use, each definition file once a file matches it, and resolved
+     * structures are cached per file and table, so looking up the tables of many files doesn't parse JSON or compile
+     * regular expressions again. Broken definitions are logged and skipped. Lookups are thread-safe, the caches are
+     * only locked exclusively to insert into them.
+     */
     template<EXPA expa>
-    auto getStructureFromFile(const std::filesystem::path& filePath, const std::string& tableName)
-        -> std::vector<StructureEntry>
+    class StructureRegistry
     {
-        std::string STRUCTURE_FILE = std::string(expa::STRUCTURE_FOLDER) + "structure.json";
-
-        if (!std::filesystem::is_directory(expa::STRUCTURE_FOLDER)) return {};
-        if (!std::filesystem::exists(STRUCTURE_FILE)) return {};
+    public:
+        StructureRegistry(const StructureRegistry&)                    = delete;
+        StructureRegistry(StructureRegistry&&)                         = delete;
+        auto operator=(const StructureRegistry&) -> StructureRegistry& = delete;
+        auto operator=(StructureRegistry&&) -> StructureRegistry&      = delete;
+        ~StructureRegistry()                                           = default;
 
-        boost::property_tree::ptree structure;
-        boost::property_tree::read_json(STRUCTURE_FILE, structure);
+        /**
+         * Gets the registry of the implementation, loading it on first use.
+         */
+        static auto get() -> StructureRegistry&
+        {
+            static StructureRegistry registry;
+            return registry;
+        }
 
-        std::string formatFile;
-        for (auto var : structure)
+        /**
+         * Finds the structure of a table within the given file. Returns an empty structure if there is none.
+         */
+        auto find(const std::filesystem::path& filePath, const std::string& tableName) -> std::vector<StructureEntry>
         {
-            if (boost::regex_search(filePath.string(), boost::regex{var.first}))
+            auto key = std::pair{filePath.string(), tableName};
             {
-                formatFile = var.second.data();
-                break;
+                const std::shared_lock lock(mutex);
+                auto itr = cache.find(key);
+                if (itr != cache.end()) return itr->second;
             }
+
+            // resolved without holding the lock, a concurrent lookup of the same table resolves the same structure
+            auto structure = resolve(key.first, tableName);
+
+            const std::unique_lock lock(mutex);
+            return cache.try_emplace(std::move(key), std::move(structure)).first->second;
         }
 
-        if (formatFile.empty()) return {};
+    private:
+        struct TableDefinition
+        {
+            std::string name;
+            boost::regex pattern;
+            std::vector<StructureEntry> structure;
+        };
 
-        boost::property_tree::ptree format;
-        boost::property_tree::read_json(expa::STRUCTURE_FOLDER + formatFile, format);
+        struct FileDefinition
+        {
+            boost::regex pattern;
+            std::string formatFile;
+        };
 
-        auto formatValue = format.get_child_optional(tableName);
-        if (!formatValue)
+        // not modified after construction, so it can be searched without the lock
+        std::vector<FileDefinition> files;
+        // file path -> matching file pattern, or nullptr if none matches
+        std::map<std::string, const FileDefinition*> fileMatches;
+        // definition files are loaded once a file matches them, as they may be shared by multiple file patterns
+        std::map<std::string, std::vector<TableDefinition>> definitions;
+        std::map<std::pair<std::string, std::string>, std::vector<StructureEntry>> cache;
+        // entries are never changed or removed once inserted, so references to them stay valid without the lock
+        std::shared_mutex mutex;
+
+        StructureRegistry()
         {
-            // Scan all table definitions to find a matching regex expression, if any
-            for (auto& kv : format)
+            std::string STRUCTURE_FILE = std::string(expa::STRUCTURE_FOLDER) + "structure.json";
+
+            if (!std::filesystem::is_directory(expa::STRUCTURE_FOLDER)) return;
+            if (!std::filesystem::exists(STRUCTURE_FILE)) return;
+
+            // a broken definition only takes away the structures it defines, not those of all other files
+            boost::property_tree::ptree structure;
+            try
+            {
+                boost::property_tree::read_json(STRUCTURE_FILE, structure);
+            }
+            catch (const boost::property_tree::ptree_error& ex)
+            {
+                log(std::format("Error: failed to read {}: {}", STRUCTURE_FILE, ex.what()));
+                return;
+            }
+
+            for (const auto& [pattern, formatFile] : structure)
             {
-                if (boost::regex_search(tableName, boost::regex{wrapRegex(kv.first)}))
+                try
+                {
+                    files.emplace_back(boost::regex{pattern}, formatFile.data());
+                }
+                catch (const boost::regex_error& ex)
                 {
-                    formatValue = kv.second;
-                    break;
+                    log(std::format("Error: skipping invalid file pattern {} in {}: {}",
+                                    pattern,
+                                    STRUCTURE_FILE,
+                                    ex.what()));
                 }
             }
         }
-        if (!formatValue) return {};
 
-        std::vector<StructureEntry> entries;
-        for (const auto& val : formatValue.get())
-            entries.emplace_back(val.first, convertEntryType(val.second.data()));
+        auto getFile(const std::string& path) -> const FileDefinition*
+        {
+            {
+                const std::shared_lock lock(mutex);
+                auto itr = fileMatches.find(path);
+                if (itr != fileMatches.end()) return itr->second;
+            }
 
-        return entries;
+            // the first matching pattern wins, in the order of the definition files
+            auto file =
+                std::ranges::find_if(files, [&](const auto& val) { return boost::regex_search(path, val.pattern); });
+            const auto* match = file == files.end() ? nullptr : &*file;
+
+            const std::unique_lock lock(mutex);
+            return fileMatches.try_emplace(path, match).first->second;
+        }
+
+        auto getDefinition(const std::string& formatFile) -> const std::vector<TableDefinition>&
+        {
+            {
+                const std::shared_lock lock(mutex);
+                auto itr = definitions.find(formatFile);
+                if (itr != definitions.end()) return itr->second;
+            }
+
+            std::vector<TableDefinition> tables;
+            try
+            {
+                tables = loadDefinition(formatFile);
+            }
+            catch (const std::exception& ex)
+            {
+                log(std::format("Error: skipping structure definition {}: {}", formatFile, ex.what()));
+            }
+
+            const std::unique_lock lock(mutex);
+            return definitions.try_emplace(formatFile, std::move(tables)).first->second;
+        }
+
+        static auto loadDefinition(const std::string& formatFile) -> std::vector<TableDefinition>
+        {
+            boost::property_tree::ptree format;
+            boost::property_tree::read_json(expa::STRUCTURE_FOLDER + formatFile, format);
+
+            std::vector<TableDefinition> tables;
+            for (const auto& [name, value] : format)
+            {
+                std::vector<StructureEntry> entries;
+                for (const auto& val : value)
+                    entries.emplace_back(val.first, convertEntryType(val.second.data()));
+
+                tables.emplace_back(name, boost::regex{wrapRegex(name)}, std::move(entries));
+            }
+
+            return tables;
+        }
+
+        auto resolve(const std::string& path, const std::string& tableName) -> std::vector<StructureEntry>
+        {
+            const auto* file = getFile(path);
+            if (file == nullptr) return {};
+
+            const auto& tables = getDefinition(file->formatFile);
+            auto table         = std::ranges::find(tables, tableName, &TableDefinition::name);
+            // Scan all table definitions to find a matching regex expression, if any
+            if (table == tables.end())
+                table = std::ranges::find_if(
+                    tables, [&](const auto& val) { return boost::regex_search(tableName, val.pattern); });
+            if (table == tables.end()) return {};
+
+            return table->structure;
+        }
+    };
+
+    template<EXPA expa>
+    auto getStructureFromFile(const std::filesystem::path& filePath, const std::string& tableName)
+        -> std::vector<StructureEntry>
+    {
+        return StructureRegistry<expa>::get().find(filePath, tableName);
     }
 
     template<EXPA expa>
-    auto getStructure(std::ifstream& stream, const std::filesystem::path& filePath, const std::string& tableName)
+    auto getStructure(ByteReader& stream, const std::filesystem::path& filePath, const std::string& tableName)
         -> Structure
     {
         auto fromFile = getStructureFromFile<expa>(filePath, tableName);
@@ -393,7 +967,7 @@ namespace mvgltools::expa::detail
 
         std::vector<StructureEntry> structure;
         auto structureCount = read<uint32_t>(stream);
-        for (int32_t j = 0; j < structureCount; j++)
+        for (int32_t j = 0; j < structureCount && stream; j++)
         {
             auto type = read<EntryType>(stream);
             structure.emplace_back(std::format("{} {}", toString(type), j), type);
@@ -410,7 +984,7 @@ namespace mvgltools::expa::detail
     }
 
     template<EXPA expa>
-    auto getStructureCSV(const CSVFile& csv, const std::filesystem::path& filePath, const std::string& tableName)
+    auto getStructureCSV(const CSVReader& csv, const std::filesystem::path& filePath, const std::string& tableName)
         -> Structure
     {
         auto structure = getCSVStructure(csv);
@@ -423,132 +997,202 @@ namespace mvgltools::expa::detail
         return Structure{fromFile};
     }
 
-} // namespace mvgltools::expa::detail
-
-// implementation
-namespace mvgltools::expa
-{
-    using namespace detail;
+    inline auto getTableName(const Table& table) -> const std::string& { return table.name; }
+    inline auto getTableName(const ColumnarTable& table) -> const std::string& { return table.getName(); }
+    inline auto getTableStructure(const Table& table) -> const Structure& { return table.structure; }
+    inline auto getTableStructure(const ColumnarTable& table) -> const Structure& { return table.getStructure(); }
+    inline auto getTableEntryCount(const Table& table) -> size_t { return table.entries.size(); }
+    inline auto getTableEntryCount(const ColumnarTable& table) -> size_t { return table.getEntryCount(); }
 
-    template<EXPA expa>
-    auto importCSV(const std::filesystem::path& source) -> std::expected<TableFile, std::string>
+    /**
+     * Encodes tables into an EXPA file held by a single buffer. The first pass plans the layout, the size of every
+     * table and of the CHNK entries of every block of rows. The second pass encodes the blocks in parallel, writing
+     * rows and CHNK entries straight to their planned place in the buffer.
+     */
+    class EXPAWriter
     {
-        if (!std::filesystem::exists(source) || !std::filesystem::is_directory(source))
-            return std::unexpected("Source path doesn't exist or is not a directory.");
-
-        const std::filesystem::directory_iterator itr(source);
-        std::vector<std::filesystem::path> files;
-        for (const auto& val : itr)
-            if (val.is_regular_file()) files.push_back(val);
-        std::ranges::sort(files);
-
-        std::vector<Table> tables;
-        for (const auto& file : files)
-        {
-            const CSVFile csv(file);
-
-            auto name      = file.stem().generic_string().substr(4);
-            auto structure = getStructureCSV<expa>(csv, source, name);
-            auto entries   = csv.getRows() |
-                           std::views::transform([&](const auto& val) { return structure.readCSV(val); }) |
-                           std::ranges::to<std::vector<std::vector<EntryValue>>>();
-
-            tables.emplace_back(name, structure, entries);
-        }
+    private:
+        template<typename TableType>
+        static auto encodeTables(const std::vector<TableType>& tables, bool hasStructureSection) -> std::vector<char>;
 
-        return TableFile{tables};
-    }
+    public:
+        static auto encode(const std::vector<Table>& tables, bool hasStructureSection) -> std::vector<char>;
+        static auto encode(const std::vector<ColumnarTable>& tables, bool hasStructureSection) -> std::vector<char>;
+    };
 
-    template<EXPA expa>
-    auto writeEXPA(const TableFile& file, const std::filesystem::path& path) -> std::expected<void, std::string>
+    template<EXPA expa, typename TableType>
+    auto writeEXPATables(const std::vector<TableType>& tables, const std::filesystem::path& path)
+        -> std::expected<void, std::string>
     {
         if (std::filesystem::exists(path) && !std::filesystem::is_regular_file(path))
             return std::unexpected("Target path already exists and is not a file.");
         if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
 
+        const auto buffer = EXPAWriter::encode(tables, expa::HAS_STRUCTURE_SECTION);
+
         std::ofstream stream(path, std::ios::out | std::ios::binary);
+        if (!stream) return std::unexpected("Failed to write target file.");
 
+        write(stream, buffer);
         if (!stream) return std::unexpected("Failed to write target file.");
 
-        std::vector<CHNKEntry> chnk;
+        return {};
+    }
+
+    template<EXPA expa, typename TableType>
+    auto importCSVTable(const std::filesystem::path& file, const std::filesystem::path& source)
+        -> std::expected<TableType, std::string>
+    {
+        // the file names start with the index of the table, e.g. 000_name.csv
+        auto stem = file.stem().generic_string();
+        if (stem.size() < 4)
+            return std::unexpected(std::format("{}: file name doesn't start with a table index.", file.string()));
+
+        CSVReader csv(file);
 
-        write(stream, EXPA_MAGIC);
-        write(stream, static_cast<uint32_t>(file.tables.size()));
+        auto name      = stem.substr(4);
+        auto structure = getStructureCSV<expa>(csv, source, name);
 
-        for (const auto& table : file.tables)
+        if constexpr (std::is_same_v<TableType, ColumnarTable>)
         {
-            const auto& structure    = table.structure;
-            const auto nameSize      = ceilInteger(static_cast<int64_t>(table.name.size() + 1), 4);
-            auto structureSize       = structure.getEXPASize();
-            auto actualStructureSize = ceilInteger(structureSize, 8);
-            write(stream, static_cast<int32_t>(nameSize));
-            write(stream, table.name, nameSize);
-
-            if constexpr (expa::HAS_STRUCTURE_SECTION)
+            // parsed straight into the columns
+            ColumnarTable table(name, structure);
+            for (size_t row = 1; csv.nextRow(); row++)
             {
-                write(stream, static_cast<uint32_t>(structure.getEntryCount()));
-                for (const auto& entry : structure.getStructure())
-                    write(stream, entry.type);
+                auto values = table.readCSV(csv.getRow());
+                if (!values) return std::unexpected(std::format("{}, row {}: {}", file.string(), row, values.error()));
             }
 
-            write(stream, structureSize);
-            write(stream, static_cast<uint32_t>(table.entries.size()));
+            return table;
+        }
+        else
+        {
+            std::vector<std::vector<EntryValue>> entries;
+            for (size_t row = 1; csv.nextRow(); row++)
+            {
+                auto values = structure.readCSV(csv.getRow());
+                if (!values) return std::unexpected(std::format("{}, row {}: {}", file.string(), row, values.error()));
+                entries.push_back(std::move(values.value()));
+            }
 
-            stream.seekp(ceilInteger(stream.tellp(), 8), std::ios::beg);
+            return Table{.name = name, .structure = structure, .entries = std::move(entries)};
+        }
+    }
 
-            for (const auto& entry : table.entries)
-            {
-                auto start  = stream.tellp();
-                auto result = structure.writeEXPA(entry);
-                write(stream, result.data);
+    template<EXPA expa, typename File>
+    auto importCSVTables(const std::filesystem::path& source) -> std::expected<File, std::string>
+    {
+        using TableType = typename decltype(File::tables)::value_type;
 
-                auto lambda = [=](CHNKEntry& val)
-                {
-                    val.offset += static_cast<uint32_t>(start);
-                    return val;
-                };
+        if (!std::filesystem::exists(source) || !std::filesystem::is_directory(source))
+            return std::unexpected("Source path doesn't exist or is not a directory.");
+
+        const std::filesystem::directory_iterator itr(source);
+        std::vector<std::filesystem::path> files;
+        for (const auto& val : itr)
+            if (val.is_regular_file()) files.push_back(val);
+        std::ranges::sort(files);
 
-                chnk.append_range(std::ranges::views::transform(result.chunk, lambda));
+        // the tables are independent, so they get parsed in parallel
+        std::vector<std::optional<std::expected<TableType, std::string>>> tables(files.size());
+        auto importTable = [&](size_t i)
+        {
+            // e.g. a broken structure definition only fails the table it's used for
+            try
+            {
+                tables[i] = importCSVTable<expa, TableType>(files[i], source);
             }
-        }
+            catch (const std::exception& ex)
+            {
+                tables[i] = std::unexpected(std::format("{}: {}", files[i].string(), ex.what()));
+            }
+        };
+        parallelFor(files.size(), importTable);
 
-        write(stream, CHNK_MAGIC);
-        write(stream, static_cast<uint32_t>(chnk.size()));
-        for (const auto& entry : chnk)
+        File result;
+        for (auto& table : tables)
         {
-            write(stream, entry.offset);
-            write(stream, static_cast<uint32_t>(entry.value.size()));
-            write(stream, entry.value);
+            if (!table.value()) return std::unexpected(table->error());
+            result.tables.push_back(std::move(table->value()));
         }
 
-        return {};
+        return result;
+    }
+
+} // namespace mvgltools::expa::detail
+
+// implementation
+namespace mvgltools::expa
+{
+    using namespace detail;
+
+    template<EXPA expa>
+    auto importCSV(const std::filesystem::path& source) -> std::expected<TableFile, std::string>
+    {
+        return importCSVTables<expa, TableFile>(source);
+    }
+
+    template<EXPA expa>
+    auto importCSVColumnar(const std::filesystem::path& source) -> std::expected<ColumnarTableFile, std::string>
+    {
+        return importCSVTables<expa, ColumnarTableFile>(source);
+    }
+
+    template<EXPA expa>
+    auto writeEXPA(const TableFile& file, const std::filesystem::path& path) -> std::expected<void, std::string>
+    {
+        return writeEXPATables<expa>(file.tables, path);
+    }
+
+    template<EXPA expa>
+    auto writeEXPA(const ColumnarTableFile& file, const std::filesystem::path& path)
+        -> std::expected<void, std::string>
+    {
+        return writeEXPATables<expa>(file.tables, path);
     }
 
     template<EXPA expa>
     auto readEXPA(const std::filesystem::path& path) -> std::expected<TableFile, std::string>
+    {
+        if (!std::filesystem::exists(path)) return std::unexpected("Source path does not exist.");
+        if (!std::filesystem::is_regular_file(path)) return std::unexpected("Source path does not lead to a file.");
+
+        const FileSource file(path);
+        if (!file) return std::unexpected("Failed to read source file.");
+
+        return readEXPA<expa>(file, path);
+    }
+
+    template<EXPA expa>
+    auto readEXPA(const ByteSource& source, const std::filesystem::path& path) -> std::expected<TableFile, std::string>
+    {
+        auto content = source.read(0, source.size());
+        if (!content) return std::unexpected(content.error());
+
+        auto view = readEXPAView<expa>(content.value(), path);
+        if (!view) return std::unexpected(view.error());
+
+        return view->toTableFile();
+    }
+
+    template<EXPA expa>
+    auto readEXPAView(std::span<const char> buffer, const std::filesystem::path& path)
+        -> std::expected<TableFileView, std::string>
     {
         struct TableEntry
         {
-            std::string name;
-            size_t dataOffset{};
+            std::string_view name;
+            uint64_t dataOffset{};
             uint32_t entryCount{};
             uint32_t entrySize{};
             Structure structure;
         };
 
-        if (!std::filesystem::exists(path)) return std::unexpected("Source path does not exist.");
-        if (!std::filesystem::is_regular_file(path)) return std::unexpected("Source path does not lead to a file.");
-
-        std::ifstream stream(path, std::ios::in | std::ios::binary);
-
-        if (!stream) return std::unexpected("Failed to read source file.");
-
-        std::vector<char> content(std::filesystem::file_size(path));
-        stream.read(content.data(), static_cast<std::streamsize>(content.size()));
-        stream.seekg(std::ios::beg);
+        const MemorySource source(buffer);
+        ByteReader stream(source);
 
         const auto header = read<EXPAHeader>(stream);
-        if (header.magic != EXPA_MAGIC) return std::unexpected("Source file lacks EXPA header.");
+        if (!stream || header.magic != EXPA_MAGIC) return std::unexpected("Source file lacks EXPA header.");
 
         std::vector<TableEntry> tables;
 
@@ -557,17 +1201,22 @@ namespace mvgltools::expa
             alignStream<expa::ALIGN_STEP>(stream);
 
             auto nameLength = read<uint32_t>(stream);
-            std::vector<char> nameData(nameLength);
-            stream.read(nameData.data(), static_cast<std::streamsize>(nameData.size()));
-            std::string name(nameData.data());
+            auto nameOffset = stream.tellg();
+            stream.seekg(nameLength, std::ios::cur);
+            if (!stream || stream.tellg() > buffer.size()) return std::unexpected("Table name exceeds the file.");
+
+            std::string_view name(buffer.data() + nameOffset, nameLength);
+            name = name.substr(0, name.find('\0'));
 
-            Structure structure = getStructure<expa>(stream, path, name);
+            Structure structure = getStructure<expa>(stream, path, std::string(name));
             auto entrySize      = read<uint32_t>(stream);
             auto entryCount     = read<uint32_t>(stream);
 
             alignStream<8>(stream);
-            tables.emplace_back(name, stream.tellg(), entryCount, entrySize, structure);
-            stream.seekg(entryCount * ceilInteger(entrySize, 8), std::ios::cur);
+            auto dataOffset = stream.tellg();
+            auto dataSize   = entryCount * static_cast<uint64_t>(ceilInteger(entrySize, 8));
+            if (!stream || dataOffset > buffer.size() || dataSize > buffer.size() - dataOffset)
+                return std::unexpected(std::format("Table {} exceeds the file.", name));
 
             auto structureSize = structure.getEXPASize();
             if (structureSize != ceilInteger(entrySize, 8))
@@ -575,38 +1224,33 @@ namespace mvgltools::expa
                 return std::unexpected(
                     std::format("Structure size {} doesn't match entry size {}.", structureSize, entrySize));
             }
+
+            tables.emplace_back(name, dataOffset, entryCount, entrySize, std::move(structure));
+            stream.seekg(dataSize, std::ios::cur);
         }
 
         alignStream<expa::ALIGN_STEP>(stream);
 
         const auto chunkHeader = read<CHNKHeader>(stream);
+        if (!stream) return std::unexpected(stream.error());
         if (chunkHeader.magic != CHNK_MAGIC) return std::unexpected("Source file lacks CHNK header.");
 
-        for (uint32_t i = 0; i < chunkHeader.numEntry; i++)
-        {
-            auto offset = read<uint32_t>(stream);
-            auto size   = read<uint32_t>(stream);
-            auto ptr    = reinterpret_cast<uint64_t>(content.data() + stream.tellg());
-            *reinterpret_cast<uint64_t*>(content.data() + offset) = ptr;
-            stream.seekg(size, std::ios::cur);
-        }
+        // pointers get resolved through the CHNK entries instead of being patched into the buffer
+        auto chunks = std::make_shared<CHNKIndex>(buffer, stream.tellg(), chunkHeader.numEntry);
 
-        std::vector<Table> finalTable;
-        for (const auto& table : tables)
+        std::vector<TableView> views;
+        views.reserve(tables.size());
+        for (auto& table : tables)
         {
-            const auto increase = ceilInteger(table.entrySize, 8);
-            auto offset         = table.dataOffset;
-            std::vector<std::vector<EntryValue>> values;
-
-            for (uint32_t i = 0; i < table.entryCount; i++)
-            {
-                values.push_back(table.structure.readEXPA(content.data() + offset));
-                offset += increase;
-            }
-
-            finalTable.emplace_back(table.name, table.structure, values);
+            views.emplace_back(table.name,
+                               std::move(table.structure),
+                               buffer,
+                               table.dataOffset,
+                               table.entryCount,
+                               table.entrySize,
+                               chunks);
         }
 
-        return TableFile{finalTable};
+        return TableFileView(std::move(views));
     }
 } // namespace mvgltools::expa
\ No newline at end of file
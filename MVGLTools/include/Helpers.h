@@ -86,8 +86,8 @@ namespace mvgltools
         return (value + step - 1) / step * step;
     }
 
-    template<int64_t step>
-    inline void alignStream(std::ifstream& stream)
+    template<int64_t step, typename Stream>
+    inline void alignStream(Stream& stream)
     {
         stream.seekg(ceilInteger(stream.tellg(), step));
     }
@@ -1,31 +1,44 @@
 #pragma once
+#include "ByteSource.h"
 #include "Compressors.h"
 #include "Helpers.h"
+#include "Parallel.h"
 
 #include <boost/asio.hpp>
 #include <boost/asio/thread_pool.hpp>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <expected>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <functional>
 #include <future>
 #include <ios>
 #include <iosfwd>
 #include <istream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <optional>
 #include <ostream>
+#include <random>
 #include <ranges>
+#include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace mvgltools::mdb1
@@ -35,7 +48,6 @@ namespace mvgltools::mdb1
      */
     template<typename T>
     concept ArchiveType = requires {
-        typename T::InputStream;
         typename T::OutputStream;
         typename T::Header;
         typename T::TreeEntry;
@@ -50,10 +62,79 @@ namespace mvgltools::mdb1
     enum class CompressMode
     {
         NONE,
+        FAST,
+        BALANCED,
         NORMAL,
         ADVANCED
     };
 
+    /**
+     * Represents the available orders of the file data within MDB1 files.
+     */
+    enum class DataLayout
+    {
+        // in the order of the file tree, as in vanilla
+        TREE,
+        // ordered by path, keeping the files of a folder together
+        PATH,
+        // grouped by size, smallest first
+        SIZE,
+        // the files of an access log first, in the order they get accessed
+        ACCESS
+    };
+
+    /**
+     * Represents the location of a file within an archive's data section.
+     */
+    struct ArchiveEntry
+    {
+        uint64_t offset;
+        uint64_t fullSize;
+        uint64_t compressedSize;
+    };
+
+    /**
+     * Represents the options used when packing MDB1 files.
+     */
+    struct PackOptions
+    {
+        CompressMode compress = CompressMode::NORMAL;
+        // number of additional files the file tables have room for, so they can be added in place later
+        uint64_t reservedEntries = 0;
+        // whether files from base archives get decompressed and compressed again instead of being copied as they are
+        bool recompress = false;
+        // whether files exceeding the limits of the archive format spill into additional archives, name.1.mvgl etc.
+        bool split = false;
+        // order of the file data, a split archive is written in path order instead of tree order
+        DataLayout layout = DataLayout::TREE;
+        // text file with one path per line, in the order the files get accessed, for DataLayout::ACCESS
+        std::filesystem::path accessLog{};
+        // alignment of the file data within the archive in bytes, 0 to store it back to back
+        uint64_t alignment = 0;
+    };
+
+    /**
+     * Represents the estimated outcome of packing an archive, without packing it.
+     */
+    struct PackEstimate
+    {
+        uint64_t fileCount = 0;
+        // size of all files before compression
+        uint64_t inputSize = 0;
+        // number of bytes compressed to estimate the outcome
+        uint64_t sampledSize = 0;
+        // estimated size of the archive, including the file tables and alignment, with a 95% confidence interval
+        uint64_t estimatedSize = 0;
+        uint64_t lowerSize     = 0;
+        uint64_t upperSize     = 0;
+        // number of archives the files get split over, for the estimated and the upper size
+        uint64_t volumeCount      = 1;
+        uint64_t upperVolumeCount = 1;
+        // limits of the archive format
+        uint64_t maxFileCount = 0;
+        uint64_t maxSize      = 0;
+    };
+
     /**
      * Represents the archive info, primarily the file list, extracted from a MDB1 file.
      */
@@ -67,6 +148,13 @@ namespace mvgltools::mdb1
          */
         explicit ArchiveInfo(const std::filesystem::path& path);
 
+        /**
+         * Construct a new ArchiveInfo by reading from the given source, e.g. a file mapped into memory or an archive
+         * stored within another archive. The source contains the archive as it is stored, if the game uses asset
+         * encryption it gets decrypted transparently. If the source is invalid/incompatible there will be no entries.
+         */
+        explicit ArchiveInfo(std::shared_ptr<const ByteSource> source);
+
         /**
          * Extract all files in the archive into the given folder.
          *
@@ -84,17 +172,40 @@ namespace mvgltools::mdb1
         auto extractSingleFile(const std::filesystem::path& output, std::string file)
             -> std::expected<void, std::string>;
 
-    private:
-        struct ArchiveEntry
-        {
-            uint64_t offset;
-            uint64_t fullSize;
-            uint64_t compressedSize;
-        };
+        /**
+         * Get all files in the archive, mapped by their name within the archive.
+         */
+        [[nodiscard]] auto getEntries() const -> const std::map<std::string, ArchiveEntry>&;
+
+        /**
+         * Reads the data of an entry as it is stored in the archive, i.e. still compressed. If the game uses asset
+         * encryption, the data will be decrypted.
+         *
+         * @param entry the entry to read
+         * @return the stored data if successful, an error string otherwise
+         */
+        auto readRawData(const ArchiveEntry& entry) const -> std::expected<std::vector<char>, std::string>;
+
+        /**
+         * Opens the data of an entry as a source, e.g. to parse an MBE file without extracting it first. Data stored
+         * uncompressed is read from the archive as needed, compressed data gets decompressed into memory.
+         *
+         * @param entry the entry to open
+         * @return the source if successful, an error string otherwise
+         */
+        auto openEntry(const ArchiveEntry& entry) const
+            -> std::expected<std::shared_ptr<const ByteSource>, std::string>;
+
+        /**
+         * Get the header of the archive, describing the location of the file tables and data section.
+         */
+        [[nodiscard]] auto getHeader() const -> const MDB::Header&;
 
-        MDB::InputStream input;
+    private:
+        // the decrypted archive
+        std::shared_ptr<const ByteSource> source;
         std::map<std::string, ArchiveEntry> entries;
-        uint64_t dataStart;
+        MDB::Header header{};
 
         auto extractFile(const std::filesystem::path& output, const ArchiveEntry& entry)
             -> std::expected<void, std::string>;
@@ -112,6 +223,151 @@ namespace mvgltools::mdb1
     auto packArchive(const std::filesystem::path& source, const std::filesystem::path& target, CompressMode compress)
         -> std::expected<void, std::string>;
 
+    /**
+     * Created a new MDB1 archive from a given folder.
+     *
+     * @param output the folder to create the archive from
+     * @param target the file to write the data into, if it doesn't exist it'll get created
+     * @param options the options to be used
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto packArchive(const std::filesystem::path& source,
+                     const std::filesystem::path& target,
+                     const PackOptions& options) -> std::expected<void, std::string>;
+
+    /**
+     * Creates a new MDB1 archive from multiple sources, which are either folders or manifest files.
+     * A manifest is a JSON object mapping the names within the archive to the files to pack, relative to its folder.
+     * The files are read from where they are, if multiple sources contain the same file the later one is used.
+     *
+     * @param sources the folders and manifests to create the archive from
+     * @param target the file to write the data into, if it doesn't exist it'll get created
+     * @param options the options to be used
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto packArchive(const std::vector<std::filesystem::path>& sources,
+                     const std::filesystem::path& target,
+                     const PackOptions& options) -> std::expected<void, std::string>;
+
+    /**
+     * Creates a new MDB1 archive from an existing archive and folders with files to replace or add.
+     * Files of the base archive that aren't replaced get copied as they are stored, without recompressing them.
+     *
+     * @param base the archive to use as base
+     * @param overlays the folders or manifests with the files to replace or add, later ones take priority
+     * @param target the file to write the data into, if it doesn't exist it'll get created
+     * @param options the options to be used, the compress mode only applies to the files from the overlay folders
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto packArchive(const std::filesystem::path& base,
+                     const std::vector<std::filesystem::path>& overlays,
+                     const std::filesystem::path& target,
+                     const PackOptions& options) -> std::expected<void, std::string>;
+
+    /**
+     * Estimates the size of the archive packArchive would create from the given sources, by compressing a sample of
+     * the files and extrapolating from it. The sample is stratified by file type and size, large files are only
+     * compressed in parts.
+     *
+     * @param sources the folders and manifests to create the archive from
+     * @param options the options to be used
+     * @return the estimate if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto estimateArchive(const std::vector<std::filesystem::path>& sources, const PackOptions& options)
+        -> std::expected<PackEstimate, std::string>;
+
+    /**
+     * Estimates the size of the archive packArchive would create from an existing archive and folders with files to
+     * replace or add. The size of the files copied from the base archive is known, only the others get estimated.
+     *
+     * @param base the archive to use as base
+     * @param overlays the folders or manifests with the files to replace or add, later ones take priority
+     * @param options the options to be used
+     * @return the estimate if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto estimateArchive(const std::filesystem::path& base,
+                         const std::vector<std::filesystem::path>& overlays,
+                         const PackOptions& options) -> std::expected<PackEstimate, std::string>;
+
+    /**
+     * Updates an existing MDB1 archive in place with folders of files to replace or add.
+     * The new data gets appended to the data section, all other data stays where it is. Only the file tables get
+     * rewritten, if they outgrow the space reserved for them the data section gets moved back.
+     * Replaced data stays in the archive as dead space until it gets compacted.
+     *
+     * The archive is left in an invalid state if the update gets interrupted, so keep a backup.
+     *
+     * @param archive the archive to update
+     * @param overlays the folders or manifests with the files to replace or add, later ones take priority
+     * @param options the options to be used, the reserved entries only apply if the file tables have to grow
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto updateArchive(const std::filesystem::path& archive,
+                       const std::vector<std::filesystem::path>& overlays,
+                       const PackOptions& options) -> std::expected<void, std::string>;
+
+    /**
+     * Merges multiple MDB1 archives of the same game into a new one, without recompressing any data.
+     * If multiple archives contain the same file the later one is used. Identical data of different archives gets
+     * stored only once.
+     *
+     * @param archives the archives to merge
+     * @param target the file to write the data into, if it doesn't exist it'll get created
+     * @param options the options to be used, the compress mode is ignored
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto mergeArchives(const std::vector<std::filesystem::path>& archives,
+                       const std::filesystem::path& target,
+                       const PackOptions& options) -> std::expected<void, std::string>;
+
+    /**
+     * Rewrites an MDB1 archive with all files compressed again using the given compress mode, e.g. to compress an
+     * uncompressed archive or to deduplicate its data. The files are decompressed and compressed in memory.
+     *
+     * @param source the archive to recompress
+     * @param target the file to write the data into, may be the same as the source
+     * @param options the options to be used
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto recompressArchive(const std::filesystem::path& source,
+                           const std::filesystem::path& target,
+                           const PackOptions& options) -> std::expected<void, std::string>;
+
+    /**
+     * Converts an MDB1 archive to another variant of the same game that only differs in the asset encryption, e.g.
+     * from the PC release of Cyber Sleuth to the console releases. The archive is streamed as it is, only the
+     * encryption gets applied or removed.
+     *
+     * @param source the archive to convert
+     * @param target the file to write the data into, if it doesn't exist it'll get created
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType From, ArchiveType To>
+    auto convertArchive(const std::filesystem::path& source, const std::filesystem::path& target)
+        -> std::expected<void, std::string>;
+
+    /**
+     * Rewrites an MDB1 archive without the data no file refers to anymore, e.g. after it got updated in place.
+     * The data gets copied as it is stored, without recompressing it.
+     *
+     * @param source the archive to compact
+     * @param target the file to write the data into, may be the same as the source
+     * @param options the options to be used, the compress mode is ignored
+     * @return void if successful, an error string otherwise
+     */
+    template<ArchiveType MDB>
+    auto compactArchive(const std::filesystem::path& source,
+                        const std::filesystem::path& target,
+                        const PackOptions& options) -> std::expected<void, std::string>;
+
 } // namespace mvgltools::mdb1
 
 /* Implementation */
@@ -199,33 +455,81 @@ namespace mvgltools::mdb1::detail
     const std::array<uint8_t, 991> CRYPT_KEY_2 = { 0x92, 0x85, 0x1D, 0xD4, 0x60, 0x7B, 0x1B, 0x3B, 0xDB, 0xFA, 0xCE, 0x92, 0x85, 0x1D, 0xD5, 0x2D, 0xA4, 0xF0, 0xCB, 0x2A, 0x3D, 0x74, 0x80, 0x1B, 0x3B, 0xDB, 0xFA, 0xCD, 0xC5, 0x5C, 0x47, 0x77, 0xE7, 0x97, 0x87, 0xB6, 0x5A, 0xAD, 0x24, 0x6F, 0x7E, 0x82, 0xB6, 0x5A, 0xAD, 0x25, 0x3D, 0x75, 0x4C, 0x78, 0xB4, 0xC0, 0x5B, 0x7B, 0x1A, 0x6D, 0xE4, 0x2F, 0x3E, 0x42, 0x76, 0x1A, 0x6D, 0xE4, 0x30, 0x0C, 0x37, 0xA7, 0x57, 0x47, 0x76, 0x1A, 0x6E, 0xB1, 0x59, 0xE1, 0xC9, 0x91, 0xB9, 0xC1, 0x28, 0xA3, 0x22, 0xD5, 0x2C, 0xD7, 0xC7, 0xF6, 0x99, 0x21, 0x08, 0x03, 0x02, 0x35, 0x0C, 0x38, 0x73, 0xB3, 0xF2, 0x66, 0x49, 0x10, 0x6C, 0x17, 0x06, 0x6A, 0x7E, 0x82, 0xB5, 0x8C, 0xB8, 0xF4, 0x00, 0x9C, 0x87, 0xB6, 0x59, 0xE1, 0xC9, 0x90, 0xEC, 0x97, 0x87, 0xB7, 0x26, 0x0A, 0x9E, 0x21, 0x09, 0xD1, 0xF9, 0x01, 0x68, 0xE4, 0x2F, 0x3F, 0x0F, 0x9F, 0xEF, 0xFF, 0xCE, 0x92, 0x86, 0xE9, 0x31, 0xD8, 0x94, 0x20, 0x3B, 0xDB, 0xFA, 0xCE, 0x92, 0x85, 0x1C, 0x08, 0x03, 0x02, 0x36, 0xD9, 0x60, 0x7C, 0xE8, 0x63, 0xE3, 0x62, 0x15, 0x6D, 0xE5, 0xFD, 0x34, 0x3F, 0x0F, 0x9F, 0xEF, 0xFE, 0x02, 0x36, 0xDA, 0x2D, 0xA4, 0xEF, 0xFE, 0x01, 0x69, 0xB1, 0x59, 0xE0, 0xFB, 0x9B, 0xBA, 0x8D, 0x85, 0x1D, 0xD4, 0x60, 0x7B, 0x1B, 0x3B, 0xDB, 0xFB, 0x9A, 0xEE, 0x32, 0xA5, 0xBC, 0x28, 0xA3, 0x23, 0xA3, 0x23, 0xA3, 0x23, 0xA3, 0x22, 0xD6, 0xFA, 0xCE, 0x92, 0x86, 0xE9, 0x30, 0x0C, 0x38, 0x74, 0x7F, 0x4F, 0xDF, 0x2F, 0x3E, 0x41, 0xA8, 0x23, 0xA3, 0x23, 0xA3, 0x22, 0xD5, 0x2D, 0xA4, 0xF0, 0xCC, 0xF7, 0x67, 0x16, 0x39, 0x40, 0xDB, 0xFB, 0x9B, 0xBA, 0x8D, 0x84, 0x4F, 0xDE, 0x62, 0x16, 0x39, 0x40, 0xDC, 0xC7, 0xF6, 0x99, 0x21, 0x08, 0x04, 0xD0, 0x2C, 0xD8, 0x94, 0x1F, 0x6F, 0x7E, 0x82, 0xB5, 0x8D, 0x85, 0x1C, 0x08, 0x04, 0xD0, 0x2C, 0xD8, 0x93, 0x53, 0x12, 0x05, 0x9C, 0x88, 0x84, 0x4F, 0xDE, 0x61, 0x48, 0x44, 0x0F, 0x9E, 0x22, 0xD5, 0x2D, 0xA5, 0xBC, 0x28, 0xA4, 0xF0, 0xCB, 0x2B, 0x0A, 0x9D, 0x55, 0xAC, 0x58, 0x14, 0xA0, 0xBC, 0x28, 0xA3, 0x22, 0xD6, 0xF9, 0x00, 0x9B, 0xBA, 0x8E, 0x52, 0x45, 0xDC, 0xC7, 0xF7, 0x67, 0x17, 0x06, 0x69, 0xB1, 0x58, 0x13, 0xD2, 0xC6, 0x29, 0x71, 0x18, 0xD4, 0x5F, 0xAE, 0xF1, 0x98, 0x54, 0xE0, 0xFC, 0x68, 0xE4, 0x2F, 0x3F, 0x0E, 0xD1, 0xF9, 0x01, 0x69, 0xB1, 0x58, 0x14, 0x9F, 0xEE, 0x32, 0xA5, 0xBD, 0xF4, 0xFF, 0xCE, 0x91, 0xB9, 0xC0, 0x5B, 0x7B, 0x1B, 0x3A, 0x0D, 0x05, 0x9C, 0x87, 0xB6, 0x5A, 0xAE, 0xF2, 0x65, 0x7C, 0xE8, 0x63, 0xE3, 0x62, 0x15, 0x6C, 0x17, 0x07, 0x36, 0xD9, 0x61, 0x48, 0x43, 0x43, 0x42, 0x75, 0x4C, 0x78, 0xB3, 0xF3, 0x33, 0x72, 0xE6, 0xCA, 0x5E, 0xE1, 0xC8, 0xC3, 0xC3, 0xC3, 0xC2, 0xF6, 0x99, 0x21, 0x08, 0x04, 0xD0, 0x2C, 0xD8, 0x94, 0x1F, 0x6E, 0xB2, 0x26, 0x0A, 0x9E, 0x22, 0xD5, 0x2D, 0xA4, 0xEF, 0xFF, 0xCF, 0x5F, 0xAF, 0xBE, 0xC2, 0xF5, 0xCC, 0xF7, 0x66, 0x4A, 0xDE, 0x61, 0x49, 0x11, 0x39, 0x41, 0xA8, 0x24, 0x70, 0x4C, 0x77, 0xE7, 0x97, 0x86, 0xEA, 0xFD, 0x34, 0x40, 0xDB, 0xFA, 0xCE, 0x92, 0x86, 0xE9, 0x31, 0xD8, 0x93, 0x52, 0x46, 0xAA, 0xBD, 0xF5, 0xCD, 0xC5, 0x5D, 0x14, 0xA0, 0xBB, 0x5A, 0xAE, 0xF2, 0x65, 0x7C, 0xE7, 0x97, 0x86, 0xEA, 0xFD, 0x34, 0x3F, 0x0E, 0xD2, 0xC5, 0x5D, 0x15, 0x6D, 0xE5, 0xFD, 0x35, 0x0C, 0x37, 0xA7, 0x57, 0x47, 0x77, 0xE7, 0x97, 0x87, 0xB6, 0x59, 0xE1, 0xC8, 0xC4, 0x8F, 0x1E, 0xA2, 0x55, 0xAD, 0x24, 0x70, 0x4C, 0x77, 0xE7, 0x96, 0xB9, 0xC0, 0x5C, 0x47, 0x76, 0x1A, 0x6D, 0xE4, 0x2F, 0x3E, 0x41, 0xA9, 0xF1, 0x98, 0x53, 0x12, 0x06, 0x69, 0xB0, 0x8C, 0xB7, 0x26, 0x0A, 0x9D, 0x54, 0xDF, 0x2E, 0x72, 0xE5, 0xFD, 0x34, 0x3F, 0x0F, 0x9F, 0xEE, 0x32, 0xA5, 0xBD, 0xF4, 0xFF, 0xCF, 0x5E, 0xE1, 0xC9, 0x91, 0xB9, 0xC0, 0x5C, 0x48, 0x43, 0x42, 0x75, 0x4C, 0x78, 0xB3, 0xF2, 0x65, 0x7C, 0xE7, 0x96, 0xB9, 0xC1, 0x28, 0xA3, 0x22, 0xD5, 0x2D, 0xA5, 0xBC, 0x27, 0xD6, 0xF9, 0x01, 0x69, 0xB1, 0x58, 0x13, 0xD2, 0xC6, 0x2A, 0x3D, 0x75, 0x4D, 0x45, 0xDC, 0xC7, 0xF6, 0x99, 0x21, 0x09, 0xD0, 0x2C, 0xD7, 0xC7, 0xF7, 0x67, 0x16, 0x39, 0x41, 0xA8, 0x24, 0x6F, 0x7E, 0x82, 0xB6, 0x59, 0xE1, 0xC9, 0x90, 0xEC, 0x98, 0x53, 0x12, 0x05, 0x9C, 0x87, 0xB6, 0x5A, 0xAD, 0x25, 0x3C, 0xA8, 0x24, 0x70, 0x4C, 0x77, 0xE6, 0xCA, 0x5E, 0xE2, 0x95, 0xED, 0x64, 0xB0, 0x8B, 0xEB, 0xCB, 0x2B, 0x0A, 0x9D, 0x55, 0xAC, 0x58, 0x13, 0xD3, 0x92, 0x86, 0xEA, 0xFD, 0x34, 0x3F, 0x0E, 0xD1, 0xF8, 0x34, 0x40, 0xDC, 0xC8, 0xC4, 0x8F, 0x1E, 0xA1, 0x89, 0x50, 0xAB, 0x8A, 0x1D, 0xD5, 0x2D, 0xA4, 0xF0, 0xCB, 0x2B, 0x0A, 0x9D, 0x55, 0xAC, 0x57, 0x46, 0xA9, 0xF0, 0xCC, 0xF7, 0x67, 0x17, 0x07, 0x36, 0xDA, 0x2E, 0x71, 0x19, 0xA1, 0x88, 0x83, 0x83, 0x83, 0x82, 0xB6, 0x5A, 0xAD, 0x25, 0x3D, 0x74, 0x80, 0x1C, 0x08, 0x04, 0xCF, 0x5F, 0xAF, 0xBF, 0x8E, 0x51, 0x78, 0xB3, 0xF3, 0x32, 0xA5, 0xBD, 0xF5, 0xCD, 0xC4, 0x90, 0xEC, 0x97, 0x87, 0xB7, 0x27, 0xD7, 0xC6, 0x29, 0x70, 0x4B, 0xAB, 0x8B, 0xEB, 0xCB, 0x2A, 0x3D, 0x74, 0x7F, 0x4F, 0xDE, 0x62, 0x15, 0x6D, 0xE5, 0xFD, 0x34, 0x40, 0xDB, 0xFA, 0xCD, 0xC4, 0x90, 0xEB, 0xCA, 0x5E, 0xE1, 0xC9, 0x91, 0xB9, 0xC1, 0x28, 0xA4, 0xEF, 0xFF, 0xCE, 0x92, 0x85, 0x1D, 0xD4, 0x5F, 0xAE, 0xF2, 0x65, 0x7D, 0xB5, 0x8D, 0x84, 0x50, 0xAC, 0x57, 0x47, 0x76, 0x1A, 0x6E, 0xB1, 0x59, 0xE0, 0xFB, 0x9B, 0xBB, 0x5B, 0x7A, 0x4D, 0x45, 0xDD, 0x95, 0xED, 0x65, 0x7D, 0xB4, 0xBF, 0x8F, 0x1F, 0x6F, 0x7E, 0x81, 0xE9, 0x30, 0x0C, 0x37, 0xA6, 0x89, 0x50, 0xAC, 0x57, 0x46, 0xAA, 0xBD, 0xF5, 0xCC, 0xF7, 0x66, 0x4A, 0xDE, 0x61, 0x48, 0x44, 0x10, 0x6C, 0x18, 0xD4, 0x5F, 0xAF, 0xBE, 0xC1, 0x28, 0xA3, 0x23, 0xA2, 0x55, 0xAC, 0x58, 0x14, 0xA0, 0xBC, 0x28, 0xA4, 0xEF, 0xFF, 0xCF, 0x5E, 0xE1, 0xC8, 0xC4, 0x8F, 0x1E, 0xA1, 0x88, 0x83, 0x82, 0xB5, 0x8C, 0xB7, 0x27, 0xD6, 0xF9, 0x00, 0x9C, 0x87, 0xB6, 0x59, 0xE1, 0xC9, 0x90, 0xEC, 0x98, 0x53, 0x13, 0xD3, 0x93, 0x53, 0x12, 0x06, 0x6A, 0x7D, 0xB5, 0x8C, 0xB8, 0xF4, 0xFF, 0xCF, 0x5F, 0xAF, 0xBE, 0xC2, 0xF5, 0xCD, 0xC4, 0x8F, 0x1F, 0x6E, 0xB1, 0x59, 0xE1, 0xC8, 0xC4, 0x90, 0xEB, 0xCA, 0x5E, 0xE2, 0x95, 0xED, 0x64, 0xAF, 0xBE, 0xC1, 0x28, 0xA3, 0x23, 0xA3, 0x23, 0xA3, 0x23, 0xA2, 0x55, 0xAD, 0x25, 0x3D, 0x74, 0x7F, 0x4F, 0xDE, 0x62, 0x16, 0x39, 0x40, 0xDC, 0xC7, 0xF7, 0x67, 0x17, 0x06, 0x69, 0xB1, 0x58, 0x13, 0xD3, 0x93, 0x53, 0x13, 0xD2, 0xC5, 0x5C, 0x47, 0x77 };
     // clang-format on
 
-    constexpr void cryptArray(char* array, std::size_t size, uint64_t offset)
+    // the combined key repeats after the product of the key lengths, as both are prime
+    constexpr uint64_t CRYPT_KEY_PERIOD = CRYPT_KEY_1.size() * CRYPT_KEY_2.size();
+
+    inline auto getCryptKey() -> const std::vector<char>&
+    {
+        static const auto key = []
+        {
+            std::vector<char> result(CRYPT_KEY_PERIOD);
+            for (size_t i = 0; i < result.size(); i++)
+                result[i] =
+                    static_cast<char>(CRYPT_KEY_1[i % CRYPT_KEY_1.size()] ^ CRYPT_KEY_2[i % CRYPT_KEY_2.size()]);
+            return result;
+        }();
+
+        return key;
+    }
+
+    inline void cryptArray(char* array, std::size_t size, uint64_t offset)
     {
-        for (size_t i = 0; i < size; i++)
-            array[i] ^= CRYPT_KEY_1[(offset + i) % 997] ^ CRYPT_KEY_2[(offset + i) % 991]; // NOLINT
+        const auto& key = getCryptKey();
+        auto keyPos     = offset % CRYPT_KEY_PERIOD;
+
+        while (size > 0)
+        {
+            auto count     = std::min<uint64_t>(size, CRYPT_KEY_PERIOD - keyPos);
+            const auto* in = key.data() + keyPos;
+            size_t i       = 0;
+
+            // word-wise, as the compiler can't vectorize the bytes of two possibly aliasing char arrays
+            for (; i + sizeof(uint64_t) <= count; i += sizeof(uint64_t))
+            {
+                uint64_t data    = 0;
+                uint64_t keyWord = 0;
+                std::memcpy(&data, array + i, sizeof(uint64_t));
+                std::memcpy(&keyWord, in + i, sizeof(uint64_t));
+                data ^= keyWord;
+                std::memcpy(array + i, &data, sizeof(uint64_t));
+            }
+            for (; i < count; i++)
+                array[i] ^= in[i]; // NOLINT
+
+            array += count;
+            size -= count;
+            keyPos = 0;
+        }
     }
 
     template<std::size_t SIZE>
-    constexpr void cryptArray(std::array<char, SIZE>& array, uint64_t offset)
+    void cryptArray(std::array<char, SIZE>& array, uint64_t offset)
     {
         cryptArray(array.data(), array.size(), offset);
     }
 
-    class dscs_ifstream : public std::ifstream
+    /**
+     * A view of a source using the asset encryption of Cyber Sleuth, decrypting the data as it gets read.
+     */
+    class CryptSource : public ByteSource
     {
     public:
-        dscs_ifstream(const std::filesystem::path& path, std::ios::openmode mode)
-            : std::ifstream(path, mode)
+        explicit CryptSource(std::shared_ptr<const ByteSource> parent)
+            : parent(std::move(parent))
         {
         }
 
-        auto read(char* dst, std::streamsize count) -> std::istream&
+        auto readAt(uint64_t offset, std::span<char> data) const -> std::expected<void, std::string> override
         {
-            auto offset = tellg();
-            std::ifstream::read(dst, count);
-            cryptArray(dst, count, offset);
-            return *this;
+            auto result = parent->readAt(offset, data);
+            if (result) cryptArray(data.data(), data.size(), offset);
+            return result;
         }
+
+        [[nodiscard]] auto size() const -> uint64_t override { return parent->size(); }
+
+    private:
+        std::shared_ptr<const ByteSource> parent;
     };
 
     class dscs_ofstream : public std::ofstream
@@ -246,10 +550,35 @@ namespace mvgltools::mdb1::detail
         }
     };
 
+    /**
+     * Whether the archive type uses the asset encryption.
+     */
+    template<ArchiveType MDB>
+    constexpr auto isEncrypted() -> bool
+    {
+        return std::is_same_v<typename MDB::OutputStream, dscs_ofstream>;
+    }
+
+    /**
+     * Wraps the source of an archive as it is stored, so reading it yields the decrypted data.
+     */
+    template<ArchiveType MDB>
+    auto decryptSource(std::shared_ptr<const ByteSource> source) -> std::shared_ptr<const ByteSource>
+    {
+        if constexpr (isEncrypted<MDB>())
+            return std::make_shared<CryptSource>(std::move(source));
+        else
+            return source;
+    }
+
     struct TreeName
     {
         std::string name;
         std::filesystem::path path;
+        // set if the file gets copied from a base archive instead of being read from path
+        std::optional<ArchiveEntry> baseEntry;
+        // index of the base archive the base entry belongs to
+        size_t baseArchive = 0;
 
         friend auto operator==(const TreeName& self, const TreeName& other) -> bool { return self.name == other.name; }
     };
@@ -271,8 +600,140 @@ namespace mvgltools::mdb1::detail
 
     constexpr uint64_t INVALID = std::numeric_limits<uint64_t>::max();
 
-    auto generateTree(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& source)
-        -> std::vector<TreeNode>;
+    constexpr auto getCompressionLevel(CompressMode mode) -> CompressionLevel
+    {
+        switch (mode)
+        {
+            case CompressMode::FAST: return CompressionLevel::FAST;
+            case CompressMode::BALANCED: return CompressionLevel::BALANCED;
+            default: return CompressionLevel::BEST;
+        }
+    }
+
+    auto buildMDB1Path(const std::filesystem::path& path) -> std::string;
+
+    auto generateTree(std::vector<TreeName> fileNames) -> std::vector<TreeNode>;
+    auto getTreeNames(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& source)
+        -> std::vector<TreeName>;
+
+    /**
+     * Sorts the files to write, given in tree or path order, according to the data layout of the options.
+     */
+    auto sortFiles(std::vector<const TreeName*>& order, const PackOptions& options) -> std::expected<void, std::string>;
+
+    /**
+     * Gets the path of a volume of a split archive. The first volume is the target itself, the others are named
+     * like name.1.mvgl.
+     */
+    auto getVolumePath(const std::filesystem::path& target, size_t volume) -> std::filesystem::path;
+
+    /**
+     * Returns whether the given file is one of the existing volumes of the split archive target.
+     */
+    auto isVolumeOf(const std::filesystem::path& file, const std::filesystem::path& target) -> bool;
+
+    /**
+     * Removes the volumes of a split archive starting with the given one, e.g. the ones left over when an archive
+     * gets written with fewer volumes than before.
+     */
+    void removeVolumes(const std::filesystem::path& target, size_t firstVolume);
+
+    /**
+     * Collects the files of the base archives and the given overlay folders or manifests. Later archives replace
+     * files of earlier ones and the overlays replace all archive files. The result is ordered by path, like in a
+     * regular pack.
+     */
+    auto collectFiles(const std::vector<const std::map<std::string, ArchiveEntry>*>& baseEntries,
+                      const std::vector<std::filesystem::path>& overlays)
+        -> std::expected<std::vector<TreeName>, std::string>;
+
+    /**
+     * Gets the start of the data section for an archive with room for the given number of files.
+     */
+    template<ArchiveType MDB>
+    constexpr auto getDataStart(uint64_t fileCount) -> uint64_t
+    {
+        return sizeof(typename MDB::Header) + sizeof(typename MDB::TreeEntry) * (fileCount + 1) +
+               sizeof(typename MDB::NameEntry) * (fileCount + 1) + sizeof(typename MDB::DataEntry) * fileCount;
+    }
+
+    constexpr auto alignUp(uint64_t value, uint64_t alignment) -> uint64_t
+    {
+        return alignment == 0 ? value : (value + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * Gets the number of files an archive can hold. One tree entry is taken by the root and the highest data ID
+     * marks entries without data.
+     */
+    template<ArchiveType MDB>
+    constexpr auto getMaxFileCount() -> uint64_t
+    {
+        return std::min<uint64_t>(std::numeric_limits<decltype(MDB::Header::fileEntryCount)>::max(),
+                                  std::numeric_limits<decltype(MDB::TreeEntry::dataId)>::max()) -
+               1;
+    }
+
+    /**
+     * Gets the size an archive can have, including its file tables.
+     */
+    template<ArchiveType MDB>
+    constexpr auto getMaxArchiveSize() -> uint64_t
+    {
+        return std::numeric_limits<decltype(MDB::Header::totalSize)>::max();
+    }
+
+    /**
+     * Moves a section of a file to a later position, working backwards in chunks so it can overlap with itself.
+     * If the game uses asset encryption, the data gets encrypted for its new position.
+     */
+    template<ArchiveType MDB>
+    auto moveData(const std::filesystem::path& path, uint64_t start, uint64_t end, uint64_t newStart)
+        -> std::expected<void, std::string>
+    {
+        constexpr uint64_t CHUNK_SIZE = 16ULL * 1024 * 1024;
+
+        auto input = decryptSource<MDB>(std::make_shared<FileSource>(path));
+        typename MDB::OutputStream output(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::vector<char> buffer(std::min(CHUNK_SIZE, end - start));
+
+        for (auto chunkEnd = end; chunkEnd > start;)
+        {
+            auto size       = std::min<uint64_t>(chunkEnd - start, buffer.size());
+            auto chunkStart = chunkEnd - size;
+
+            if (!input->readAt(chunkStart, std::span(buffer).first(size)))
+                return std::unexpected("Error: failed to read data from the archive.");
+
+            output.seekp(newStart + (chunkStart - start));
+            output.write(buffer.data(), size);
+            output.flush();
+            if (!output) return std::unexpected("Error: failed to write data to the archive.");
+
+            chunkEnd = chunkStart;
+        }
+
+        return {};
+    }
+
+    template<Compressor Compress>
+    auto compressData(std::vector<char> data, CompressMode mode) -> CompressionResult
+    {
+        auto checksum = mode == CompressMode::ADVANCED ? getChecksum(data) : 0;
+
+        if (data.empty() || Compress::isCompressed(data) || mode == CompressMode::NONE)
+            return CompressionResult{.originalSize = data.size(), .crc = checksum, .data = data};
+
+        auto compressed = Compress::compress(data, getCompressionLevel(mode)).value_or(data);
+
+        if (compressed.size() + 4 >= data.size()) compressed = data;
+
+        return CompressionResult{
+            .originalSize = data.size(),
+            .crc          = checksum,
+            .data         = compressed,
+        };
+    }
 
     template<Compressor Compress>
     auto getFileData(const std::filesystem::path& file, CompressMode mode)
@@ -287,21 +748,77 @@ namespace mvgltools::mdb1::detail
         std::vector<char> data(size);
         input.read(data.data(), static_cast<std::streamsize>(data.size()));
 
-        auto checksum = mode == CompressMode::ADVANCED ? getChecksum(data) : 0;
+        return compressData<Compress>(std::move(data), mode);
+    }
 
-        if (size == 0 || Compress::isCompressed(data) || mode == CompressMode::NONE)
-            return CompressionResult{.originalSize = data.size(), .crc = checksum, .data = data};
+    /**
+     * Reads a file from an archive and compresses it again.
+     */
+    template<ArchiveType MDB>
+    auto getArchiveFileData(const ArchiveInfo<MDB>& archive, const ArchiveEntry& entry, CompressMode mode)
+        -> std::expected<CompressionResult, std::string>
+    {
+        auto raw = archive.readRawData(entry);
+        if (!raw) return std::unexpected(raw.error());
 
-        auto compressed = Compress::compress(data).value_or(data);
+        auto data = MDB::Compressor::decompress(raw.value(), entry.fullSize);
+        if (!data) return std::unexpected(data.error());
 
-        if (compressed.size() + 4 >= data.size()) compressed = data;
+        return compressData<typename MDB::Compressor>(std::move(data.value()), mode);
+    }
 
-        return CompressionResult{
-            .originalSize = data.size(),
-            .crc          = checksum,
-            .data         = compressed,
-        };
+    /**
+     * Calls the given function with the path to write the target to. If the target is the source, that's a temporary
+     * file replacing the target once the function succeeded, together with the additional volumes of a split archive.
+     * Only the source itself gets rewritten, so other volumes it already has are archives that must not be replaced.
+     */
+    template<typename Func>
+    auto writeReplacing(const std::filesystem::path& source, const std::filesystem::path& target, Func func)
+        -> std::expected<void, std::string>
+    {
+        if (!file_equivalent(source, target)) return func(target);
+
+        auto tempPath = target;
+        tempPath += ".tmp";
+
+        auto result = func(tempPath);
+        if (result && std::filesystem::exists(getVolumePath(tempPath, 1)) &&
+            std::filesystem::exists(getVolumePath(target, 1)))
+            result = std::unexpected(std::format("The archive has to be split, but {} is already another volume of it.",
+                                                 getVolumePath(target, 1).string()));
+        if (!result)
+        {
+            removeVolumes(tempPath, 0);
+            return result;
+        }
+
+        size_t volume = 0;
+        for (; std::filesystem::exists(getVolumePath(tempPath, volume)); volume++)
+            std::filesystem::rename(getVolumePath(tempPath, volume), getVolumePath(target, volume));
+
+        if (std::filesystem::exists(getVolumePath(target, volume)))
+            log(std::format("[Pack] Only {} was rewritten, its other volumes stay as they are.", target.string()));
+        return {};
     }
+
+    template<ArchiveType MDB>
+    auto getTableData(const std::vector<TreeNode>& tree,
+                      const std::map<std::string, size_t>& dataIds,
+                      const std::vector<typename MDB::DataEntry>& dataEntries,
+                      uint64_t dataStart,
+                      uint64_t totalSize) -> std::vector<char>;
+
+    template<ArchiveType MDB>
+    auto writeArchive(const std::vector<TreeName>& files,
+                      std::span<ArchiveInfo<MDB>> bases,
+                      const std::filesystem::path& target,
+                      const PackOptions& options,
+                      bool inPlace) -> std::expected<void, std::string>;
+
+    template<ArchiveType MDB>
+    auto estimateFiles(const std::vector<TreeName>& files,
+                       std::span<ArchiveInfo<MDB>> bases,
+                       const PackOptions& options) -> std::expected<PackEstimate, std::string>;
 } // namespace mvgltools::mdb1::detail
 
 // implementation
@@ -314,7 +831,6 @@ namespace mvgltools::mdb1
      */
     struct DSCS
     {
-        using InputStream  = dscs_ifstream;
         using OutputStream = dscs_ofstream;
         using Header       = MDB1Header32;
         using TreeEntry    = FileTreeEntry32;
@@ -333,7 +849,6 @@ namespace mvgltools::mdb1
      */
     struct DSCSNoCrypt
     {
-        using InputStream  = std::ifstream;
         using OutputStream = std::ofstream;
         using Header       = MDB1Header32;
         using TreeEntry    = FileTreeEntry32;
@@ -352,7 +867,6 @@ namespace mvgltools::mdb1
      */
     struct DSTS
     {
-        using InputStream  = std::ifstream;
         using OutputStream = std::ofstream;
         using Header       = MDB1Header64;
         using TreeEntry    = FileTreeEntry64;
@@ -371,7 +885,6 @@ namespace mvgltools::mdb1
      */
     struct THL
     {
-        using InputStream  = std::ifstream;
         using OutputStream = std::ofstream;
         using Header       = MDB1Header64;
         using TreeEntry    = FileTreeEntry64;
@@ -385,20 +898,114 @@ namespace mvgltools::mdb1
         static_assert(sizeof(DataEntry) == 0x18);
     };
 
+    /**
+     * Builds an MDB1 archive from files added one at a time, either as data in memory or as files on disk, without
+     * staging them in a folder first. The files get compressed in the background as soon as they are added, the file
+     * tree and tables are created when the archive gets finished. The compressed data is kept in memory until then.
+     *
+     * The data is written in tree order, as with packArchive, the layout and split options don't apply.
+     */
     template<ArchiveType MDB>
-    ArchiveInfo<MDB>::ArchiveInfo(const std::filesystem::path& path)
-        : input(path, std::ios::in | std::ios::binary)
+    class ArchiveBuilder
     {
-        if (!input) return;
-
-        auto header = read<typename MDB::Header>(input);
-
-        if (header.magicValue != MDB1_MAGIC_VALUE) throw std::runtime_error("Given file is not a MVGL archive!");
+    public:
+        explicit ArchiveBuilder(const PackOptions& options = {});
+        ArchiveBuilder(const ArchiveBuilder&)                    = delete;
+        ArchiveBuilder(ArchiveBuilder&&)                         = delete;
+        auto operator=(const ArchiveBuilder&) -> ArchiveBuilder& = delete;
+        auto operator=(ArchiveBuilder&&) -> ArchiveBuilder&      = delete;
+        ~ArchiveBuilder();
 
-        dataStart = header.dataStart;
+        /**
+         * Adds a file to the archive, replacing a previously added file of the same name.
+         *
+         * @param name the path of the file within the archive, e.g. data/chara.mbe
+         * @param data the content of the file
+         * @return void if successful, an error string otherwise
+         */
+        auto add(const std::filesystem::path& name, std::vector<char> data) -> std::expected<void, std::string>;
+
+        /**
+         * Adds a file on disk to the archive, replacing a previously added file of the same name.
+         *
+         * @param name the path of the file within the archive, e.g. data/chara.mbe
+         * @param file the file to read the content from
+         * @return void if successful, an error string otherwise
+         */
+        auto addFile(const std::filesystem::path& name, const std::filesystem::path& file)
+            -> std::expected<void, std::string>;
+
+        /**
+         * Waits for all files to be compressed and writes the archive. No files can be added afterwards.
+         *
+         * @param target the file to write the archive into, if it doesn't exist it'll get created
+         * @return void if successful, an error string otherwise
+         */
+        auto finish(const std::filesystem::path& target) -> std::expected<void, std::string>;
+
+        /**
+         * Waits for all files to be compressed and writes the archive. No files can be added afterwards.
+         * The archive is written front to back, so the output doesn't have to be seekable.
+         *
+         * @param output the stream to write the archive into
+         * @return void if successful, an error string otherwise
+         */
+        auto finish(std::ostream& output) -> std::expected<void, std::string>;
+
+    private:
+        using Result = std::expected<CompressionResult, std::string>;
+
+        // compresses a file on the shared pool, or in finish if the pool didn't get to it yet
+        struct Task
+        {
+            std::packaged_task<Result()> task;
+            std::future<Result> result;
+            std::atomic<bool> started{false};
+
+            void run()
+            {
+                if (!started.exchange(true)) task();
+            }
+        };
+
+        PackOptions options;
+        // path within the archive -> compressed data, ordered by path like in a regular pack
+        std::map<std::filesystem::path, std::shared_ptr<Task>> files;
+        bool finished = false;
+
+        auto addTask(const std::filesystem::path& name, std::function<Result()> task)
+            -> std::expected<void, std::string>;
+    };
+
+    template<ArchiveType MDB>
+    ArchiveInfo<MDB>::ArchiveInfo(const std::filesystem::path& path)
+        : ArchiveInfo(std::make_shared<FileSource>(path))
+    {
+    }
+
+    template<ArchiveType MDB>
+    ArchiveInfo<MDB>::ArchiveInfo(std::shared_ptr<const ByteSource> source)
+        : source(decryptSource<MDB>(std::move(source)))
+    {
+        ByteReader headerInput(*this->source);
+        auto fileHeader = read<typename MDB::Header>(headerInput);
+        if (!headerInput) return;
+
+        if (fileHeader.magicValue != MDB1_MAGIC_VALUE) throw std::runtime_error("Given file is not a MVGL archive!");
+        header = fileHeader;
 
         assert(header.fileEntryCount == header.fileNameCount);
 
+        // the tables get read at once, as reading them entry by entry would take a read call each
+        auto tableSize = sizeof(typename MDB::TreeEntry) * header.fileEntryCount +
+                         sizeof(typename MDB::NameEntry) * header.fileNameCount +
+                         sizeof(typename MDB::DataEntry) * header.dataEntryCount;
+        auto tables = this->source->read(sizeof(typename MDB::Header), tableSize);
+        if (!tables) return;
+
+        const MemorySource tableSource(std::move(tables.value()));
+        ByteReader input(tableSource);
+
         std::vector<typename MDB::TreeEntry> treeEntries;
         std::vector<typename MDB::NameEntry> nameEntries;
         std::vector<typename MDB::DataEntry> dataEntries;
@@ -458,16 +1065,54 @@ namespace mvgltools::mdb1
         return extractFile(output, entries.at(file));
     }
 
+    template<ArchiveType MDB>
+    auto ArchiveInfo<MDB>::getEntries() const -> const std::map<std::string, ArchiveEntry>&
+    {
+        return entries;
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveInfo<MDB>::readRawData(const ArchiveEntry& entry) const
+        -> std::expected<std::vector<char>, std::string>
+    {
+        std::vector<char> data(entry.compressedSize);
+
+        if (!source->readAt(header.dataStart + entry.offset, data))
+            return std::unexpected("Error: failed to read data from the archive.");
+        return data;
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveInfo<MDB>::openEntry(const ArchiveEntry& entry) const
+        -> std::expected<std::shared_ptr<const ByteSource>, std::string>
+    {
+        // data that didn't get smaller by compressing it is stored as it is
+        if (entry.compressedSize == entry.fullSize)
+            return std::make_shared<SubSource>(source, header.dataStart + entry.offset, entry.fullSize);
+
+        auto raw = readRawData(entry);
+        if (!raw) return std::unexpected(raw.error());
+
+        auto data = MDB::Compressor::decompress(raw.value(), entry.fullSize);
+        if (!data) return std::unexpected(data.error());
+
+        return std::make_shared<MemorySource>(std::move(data.value()));
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveInfo<MDB>::getHeader() const -> const MDB::Header&
+    {
+        return header;
+    }
+
     template<ArchiveType MDB>
     auto ArchiveInfo<MDB>::extractFile(const std::filesystem::path& output, const ArchiveEntry& entry)
         -> std::expected<void, std::string>
     {
-        std::vector<char> inputData(entry.compressedSize);
-
-        input.seekg(dataStart + entry.offset);
-        input.read(inputData.data(), inputData.size());
+        auto inputData = readRawData(entry);
+        if (!inputData) return std::unexpected(inputData.error());
 
-        auto result = MDB::Compressor::decompress(inputData, entry.fullSize);
+        auto result = MDB::Compressor::decompress(inputData.value(), entry.fullSize);
         if (!result) return std::unexpected(result.error());
 
         if (std::filesystem::exists(output) && !std::filesystem::is_regular_file(output))
@@ -482,6 +1127,14 @@ namespace mvgltools::mdb1
     template<ArchiveType MDB>
     auto packArchive(const std::filesystem::path& source, const std::filesystem::path& target, CompressMode compress)
         -> std::expected<void, std::string>
+    {
+        return packArchive<MDB>(source, target, PackOptions{.compress = compress});
+    }
+
+    template<ArchiveType MDB>
+    auto packArchive(const std::filesystem::path& source,
+                     const std::filesystem::path& target,
+                     const PackOptions& options) -> std::expected<void, std::string>
     {
         if (!std::filesystem::exists(source) || !std::filesystem::is_directory(source))
             return std::unexpected("Source path does not exist or is not a directory.");
@@ -495,38 +1148,370 @@ namespace mvgltools::mdb1
 
         std::ranges::sort(files);
 
-        log("[Pack] Generating File Tree...");
-        auto tree = generateTree(files, source);
+        return writeArchive<MDB>(getTreeNames(files, source), {}, target, options, false);
+    }
 
-        // start compressing files
-        std::map<std::string, std::promise<std::expected<CompressionResult, std::string>>> futureMap;
-        // twice the core count to account for blocking threads
-        auto threadCount = std::thread::hardware_concurrency() * 2;
-        boost::asio::thread_pool pool(threadCount);
-        log(std::format("[Pack] Start compressing files with {} threads...", threadCount));
+    template<ArchiveType MDB>
+    auto packArchive(const std::vector<std::filesystem::path>& sources,
+                     const std::filesystem::path& target,
+                     const PackOptions& options) -> std::expected<void, std::string>
+    {
+        if (sources.empty()) return std::unexpected("No source given.");
+        if (target.has_parent_path() && !std::filesystem::exists(target))
+            std::filesystem::create_directories(target.parent_path());
 
-        for (const auto& file : tree)
+        auto files = collectFiles({}, sources);
+        if (!files) return std::unexpected(files.error());
+
+        return writeArchive<MDB>(files.value(), {}, target, options, false);
+    }
+
+    template<ArchiveType MDB>
+    auto packArchive(const std::filesystem::path& base,
+                     const std::vector<std::filesystem::path>& overlays,
+                     const std::filesystem::path& target,
+                     const PackOptions& options) -> std::expected<void, std::string>
+    {
+        if (!std::filesystem::is_regular_file(base)) return std::unexpected("Base archive does not exist.");
+        if (file_equivalent(base, target)) return std::unexpected("Base archive and output file must be different.");
+        if (isVolumeOf(base, target)) return std::unexpected("Base archive must not be a volume of the output file.");
+        if (target.has_parent_path() && !std::filesystem::exists(target))
+            std::filesystem::create_directories(target.parent_path());
+
+        ArchiveInfo<MDB> baseArchive(base);
+
+        auto files = collectFiles({&baseArchive.getEntries()}, overlays);
+        if (!files) return std::unexpected(files.error());
+
+        return writeArchive<MDB>(files.value(), {&baseArchive, 1}, target, options, false);
+    }
+
+    template<ArchiveType MDB>
+    auto estimateArchive(const std::vector<std::filesystem::path>& sources, const PackOptions& options)
+        -> std::expected<PackEstimate, std::string>
+    {
+        if (sources.empty()) return std::unexpected("No source given.");
+
+        auto files = collectFiles({}, sources);
+        if (!files) return std::unexpected(files.error());
+
+        return estimateFiles<MDB>(files.value(), {}, options);
+    }
+
+    template<ArchiveType MDB>
+    auto estimateArchive(const std::filesystem::path& base,
+                         const std::vector<std::filesystem::path>& overlays,
+                         const PackOptions& options) -> std::expected<PackEstimate, std::string>
+    {
+        if (!std::filesystem::is_regular_file(base)) return std::unexpected("Base archive does not exist.");
+
+        ArchiveInfo<MDB> baseArchive(base);
+
+        auto files = collectFiles({&baseArchive.getEntries()}, overlays);
+        if (!files) return std::unexpected(files.error());
+
+        return estimateFiles<MDB>(files.value(), {&baseArchive, 1}, options);
+    }
+
+    template<ArchiveType MDB>
+    auto updateArchive(const std::filesystem::path& archive,
+                       const std::vector<std::filesystem::path>& overlays,
+                       const PackOptions& options) -> std::expected<void, std::string>
+    {
+        if (!std::filesystem::is_regular_file(archive)) return std::unexpected("Archive does not exist.");
+
+        ArchiveInfo<MDB> info(archive);
+
+        auto files = collectFiles({&info.getEntries()}, overlays);
+        if (!files) return std::unexpected(files.error());
+
+        return writeArchive<MDB>(files.value(), {&info, 1}, archive, options, true);
+    }
+
+    template<ArchiveType MDB>
+    auto mergeArchives(const std::vector<std::filesystem::path>& archives,
+                       const std::filesystem::path& target,
+                       const PackOptions& options) -> std::expected<void, std::string>
+    {
+        if (archives.empty()) return std::unexpected("No archive given.");
+        for (const auto& archive : archives)
         {
-            if (file.compareBit == std::numeric_limits<decltype(file.compareBit)>::max()) continue;
+            if (!std::filesystem::is_regular_file(archive))
+                return std::unexpected(std::format("Archive {} does not exist.", archive.string()));
+            if (file_equivalent(archive, target))
+                return std::unexpected("Merged archives and output file must be different.");
+            if (isVolumeOf(archive, target))
+                return std::unexpected("Merged archives must not be volumes of the output file.");
+        }
+        if (target.has_parent_path() && !std::filesystem::exists(target))
+            std::filesystem::create_directories(target.parent_path());
 
-            futureMap[file.name.name] = std::promise<std::expected<CompressionResult, std::string>>();
+        std::vector<ArchiveInfo<MDB>> bases(archives.begin(), archives.end());
 
-            auto lambda = [&]
-            { futureMap[file.name.name].set_value(getFileData<typename MDB::Compressor>(file.name.path, compress)); };
+        auto files = collectFiles(bases | std::views::transform([](const auto& base) { return &base.getEntries(); }) |
+                                      std::ranges::to<std::vector>(),
+                                  {});
+        if (!files) return std::unexpected(files.error());
 
-            boost::asio::post(pool, lambda);
+        return writeArchive<MDB>(files.value(), bases, target, options, false);
+    }
+
+    template<ArchiveType From, ArchiveType To>
+    auto convertArchive(const std::filesystem::path& source, const std::filesystem::path& target)
+        -> std::expected<void, std::string>
+    {
+        static_assert(std::is_same_v<typename From::Header, typename To::Header> &&
+                          std::is_same_v<typename From::TreeEntry, typename To::TreeEntry> &&
+                          std::is_same_v<typename From::NameEntry, typename To::NameEntry> &&
+                          std::is_same_v<typename From::DataEntry, typename To::DataEntry> &&
+                          std::is_same_v<typename From::Compressor, typename To::Compressor>,
+                      "Archive types must only differ in their encryption.");
+        constexpr uint64_t CHUNK_SIZE = 16ULL * 1024 * 1024;
+        constexpr bool CRYPT          = isEncrypted<From>() != isEncrypted<To>();
+
+        if (!std::filesystem::is_regular_file(source)) return std::unexpected("Input path is not a file.");
+        if (file_equivalent(source, target)) return std::unexpected("Input and output file must be different.");
+        if (target.has_parent_path() && !std::filesystem::exists(target))
+            std::filesystem::create_directories(target.parent_path());
+
+        {
+            auto input = decryptSource<From>(std::make_shared<FileSource>(source));
+            ByteReader reader(*input);
+            auto header = read<typename From::Header>(reader);
+            if (!reader || header.magicValue != MDB1_MAGIC_VALUE)
+                return std::unexpected("Given file is not a MVGL archive of the given game.");
         }
 
-        std::vector<typename MDB::TreeEntry> treeEntries;
-        std::vector<typename MDB::NameEntry> nameEntries;
+        std::ifstream input(source, std::ios::in | std::ios::binary);
+        std::ofstream output(target, std::ios::out | std::ios::binary);
+        if (!input) return std::unexpected(std::format("Error: failed to open {} for reading.", source.string()));
+        if (!output) return std::unexpected(std::format("Error: failed to open {} for writing.", target.string()));
+
+        std::vector<char> buffer(CHUNK_SIZE);
+        uint64_t offset = 0;
+
+        // the encryption is a keystream by absolute offset, so every chunk can be converted on its own
+        while (input)
+        {
+            input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            auto count = static_cast<size_t>(input.gcount());
+            if (count == 0) break;
+
+            if constexpr (CRYPT) cryptArray(buffer.data(), count, offset);
+            output.write(buffer.data(), static_cast<std::streamsize>(count));
+            offset += count;
+        }
+
+        // a read error ends the loop just like the end of the file does
+        if (input.bad() || offset != std::filesystem::file_size(source))
+            return std::unexpected(std::format("Error: failed to read {}.", source.string()));
+        if (!output) return std::unexpected("Error: failed to write the converted archive.");
+        return {};
+    }
+
+    template<ArchiveType MDB>
+    auto compactArchive(const std::filesystem::path& source,
+                        const std::filesystem::path& target,
+                        const PackOptions& options) -> std::expected<void, std::string>
+    {
+        auto compactOptions       = options;
+        compactOptions.recompress = false;
+
+        return writeReplacing(source,
+                              target,
+                              [&](const auto& path) { return packArchive<MDB>(source, {}, path, compactOptions); });
+    }
+
+    template<ArchiveType MDB>
+    auto recompressArchive(const std::filesystem::path& source,
+                           const std::filesystem::path& target,
+                           const PackOptions& options) -> std::expected<void, std::string>
+    {
+        auto recompressOptions       = options;
+        recompressOptions.recompress = true;
+
+        return writeReplacing(source,
+                              target,
+                              [&](const auto& path) { return packArchive<MDB>(source, {}, path, recompressOptions); });
+    }
+
+    template<ArchiveType MDB>
+    ArchiveBuilder<MDB>::ArchiveBuilder(const PackOptions& options)
+        : options(options)
+    {
+    }
+
+    template<ArchiveType MDB>
+    ArchiveBuilder<MDB>::~ArchiveBuilder()
+    {
+        // files that weren't compressed yet are no longer needed
+        for (auto& [path, task] : files)
+            task->started = true;
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveBuilder<MDB>::addTask(const std::filesystem::path& name, std::function<Result()> task)
+        -> std::expected<void, std::string>
+    {
+        if (finished) return std::unexpected("Files can't be added to a finished archive.");
+
+        auto relPath = name.generic_string();
+        std::ranges::replace(relPath, '\\', '/');
+        if (!std::filesystem::path(relPath).has_extension())
+            return std::unexpected(std::format("File {} has no extension, the archive format requires one.", relPath));
+
+        auto entry    = std::make_shared<Task>();
+        entry->task   = std::packaged_task<Result()>(std::move(task));
+        entry->result = entry->task.get_future();
+        postTask([entry] { entry->run(); });
+
+        // a replaced file doesn't need to be compressed anymore
+        auto& slot = files[relPath];
+        if (slot) slot->started = true;
+        slot = std::move(entry);
+        return {};
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveBuilder<MDB>::add(const std::filesystem::path& name, std::vector<char> data)
+        -> std::expected<void, std::string>
+    {
+        return addTask(name,
+                       [data = std::move(data), compress = options.compress]() mutable -> Result
+                       { return compressData<typename MDB::Compressor>(std::move(data), compress); });
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveBuilder<MDB>::addFile(const std::filesystem::path& name, const std::filesystem::path& file)
+        -> std::expected<void, std::string>
+    {
+        if (!std::filesystem::is_regular_file(file))
+            return std::unexpected(std::format("File {} for {} does not exist.", file.string(), name.string()));
+
+        return addTask(name,
+                       [file, compress = options.compress]
+                       { return getFileData<typename MDB::Compressor>(file, compress); });
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveBuilder<MDB>::finish(const std::filesystem::path& target) -> std::expected<void, std::string>
+    {
+        std::ofstream output(target, std::ios::out | std::ios::binary);
+        if (!output) return std::unexpected(std::format("Error: failed to open {} for writing.", target.string()));
+
+        return finish(output);
+    }
+
+    template<ArchiveType MDB>
+    auto ArchiveBuilder<MDB>::finish(std::ostream& output) -> std::expected<void, std::string>
+    {
+        constexpr auto maxFiles = getMaxFileCount<MDB>();
+        constexpr auto maxSize  = getMaxArchiveSize<MDB>();
+
+        if (finished) return std::unexpected("The archive has already been finished.");
+        finished = true;
+
+        if (files.empty()) return std::unexpected("The archive doesn't contain any files.");
+        if (options.reservedEntries >= maxFiles || files.size() > maxFiles - options.reservedEntries)
+            return std::unexpected(std::format("{} files and {} reserved entries exceed the {} files the archive "
+                                               "format supports.",
+                                               files.size(),
+                                               options.reservedEntries,
+                                               maxFiles));
+
+        std::vector<TreeName> names;
+        std::map<std::string, CompressionResult> results;
+        for (auto& [path, task] : files)
+        {
+            task->run();
+            auto result = task->result.get();
+            if (!result) return std::unexpected(result.error());
+
+            auto name = buildMDB1Path(path);
+            names.push_back(TreeName{.name = name, .path = {}, .baseEntry = std::nullopt});
+            results[name] = std::move(result.value());
+        }
+
+        log("[Pack] Generating File Tree...");
+        auto tree = generateTree(std::move(names));
+
+        // the data section is laid out completely before writing, so the tables can come first
+        auto dataStart  = alignUp(getDataStart<MDB>(files.size() + options.reservedEntries), options.alignment);
+        uint64_t offset = 0;
         std::vector<typename MDB::DataEntry> dataEntries;
+        std::vector<std::vector<char>*> dataBlobs;
+        // CRC -> data ID of compressed files, for deduplication
+        std::map<uint64_t, size_t> dataMap;
+        std::map<std::string, size_t> dataIds;
+
+        for (const auto& node : tree)
+        {
+            if (node.compareBit == std::numeric_limits<decltype(node.compareBit)>::max()) continue;
+
+            auto& result = results.at(node.name.name);
+            auto dedup   = options.compress == CompressMode::ADVANCED;
+            if (auto existing = dataMap.find(result.crc); dedup && existing != dataMap.end())
+            {
+                dataIds[node.name.name] = existing->second;
+                continue;
+            }
+
+            auto start = alignUp(dataStart + offset, options.alignment) - dataStart;
+            if (result.originalSize > std::numeric_limits<decltype(MDB::DataEntry::fullSize)>::max())
+                return std::unexpected(std::format("File {} is too large for the archive format.", node.name.name));
+            if (dataStart + start + result.data.size() > maxSize)
+                return std::unexpected(std::format("The archive exceeds the {} bytes the archive format supports at "
+                                                   "file {}.",
+                                                   maxSize,
+                                                   node.name.name));
+
+            dataEntries.push_back({
+                .offset         = static_cast<decltype(MDB::DataEntry::offset)>(start),
+                .fullSize       = static_cast<decltype(MDB::DataEntry::fullSize)>(result.originalSize),
+                .compressedSize = static_cast<decltype(MDB::DataEntry::compressedSize)>(result.data.size()),
+            });
+            dataBlobs.push_back(&result.data);
+            dataMap[result.crc] = dataIds[node.name.name] = dataEntries.size() - 1;
+            offset                                        = start + result.data.size();
+        }
+
+        // padding is left unencrypted, like the gaps of a packed archive
+        auto position = uint64_t{0};
+        auto write    = [&](std::vector<char>& data, uint64_t start)
+        {
+            std::vector<char> padding(start - position);
+            output.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+            if constexpr (isEncrypted<MDB>()) cryptArray(data.data(), data.size(), start);
+            output.write(data.data(), static_cast<std::streamsize>(data.size()));
+            position = start + data.size();
+        };
+
+        auto tables = getTableData<MDB>(tree, dataIds, dataEntries, dataStart, dataStart + offset);
+        write(tables, 0);
+        for (size_t i = 0; i < dataBlobs.size(); i++)
+            write(*dataBlobs[i], dataStart + dataEntries[i].offset);
 
-        const auto fileCount     = files.size();
-        const auto headerSize    = sizeof(typename MDB::Header);
-        const auto treeEntrySize = sizeof(typename MDB::TreeEntry) * (fileCount + 1);
-        const auto nameEntrySize = sizeof(typename MDB::NameEntry) * (fileCount + 1);
-        const auto dataEntrySize = sizeof(typename MDB::DataEntry) * (fileCount);
-        const auto dataStart     = headerSize + treeEntrySize + nameEntrySize + dataEntrySize;
+        output.flush();
+        if (!output) return std::unexpected("Error: failed to write the archive.");
+        return {};
+    }
+} // namespace mvgltools::mdb1
+
+namespace mvgltools::mdb1::detail
+{
+    /**
+     * Creates the header and file tables of an archive for the given file tree, with the data IDs of the files mapped
+     * by their name.
+     */
+    template<ArchiveType MDB>
+    auto getTableData(const std::vector<TreeNode>& tree,
+                      const std::map<std::string, size_t>& dataIds,
+                      const std::vector<typename MDB::DataEntry>& dataEntries,
+                      uint64_t dataStart,
+                      uint64_t totalSize) -> std::vector<char>
+    {
+        std::vector<typename MDB::TreeEntry> treeEntries;
+        std::vector<typename MDB::NameEntry> nameEntries;
 
         treeEntries.push_back({
             .compareBit = std::numeric_limits<decltype(MDB::TreeEntry::compareBit)>::max(),
@@ -536,58 +1521,648 @@ namespace mvgltools::mdb1
         });
         nameEntries.push_back({});
 
-        auto fileId = 0;
-        std::map<uint32_t, size_t> dataMap;
-        size_t offset = 0;
-        typename MDB::OutputStream output(target, std::ios::out | std::ios::binary);
-
         for (const auto& file : tree)
         {
             if (file.compareBit == std::numeric_limits<decltype(file.compareBit)>::max()) continue;
 
-            if (fileId++ % 200 == 0) log(std::format("[Pack] Writing File {} of {}", fileId, fileCount));
-
-            auto data = futureMap[file.name.name].get_future().get();
-            if (!data) return std::unexpected(data.error());
-
-            auto existingData = compress == CompressMode::ADVANCED ? dataMap.find(data->crc) : dataMap.end();
-            auto dataId       = existingData == dataMap.end() ? dataEntries.size() : existingData->second;
-
             treeEntries.push_back({
                 .compareBit = static_cast<decltype(MDB::TreeEntry::compareBit)>(file.compareBit),
-                .dataId     = static_cast<decltype(MDB::TreeEntry::dataId)>(dataId),
+                .dataId     = static_cast<decltype(MDB::TreeEntry::dataId)>(dataIds.at(file.name.name)),
                 .left       = static_cast<decltype(MDB::TreeEntry::left)>(file.left),
                 .right      = static_cast<decltype(MDB::TreeEntry::right)>(file.right),
             });
             nameEntries.emplace_back(file.name.name);
-            if (existingData == dataMap.end())
-            {
-                dataMap[data->crc] = dataId;
-                dataEntries.push_back({
-                    .offset         = static_cast<decltype(MDB::DataEntry::offset)>(offset),
-                    .fullSize       = static_cast<decltype(MDB::DataEntry::fullSize)>(data->originalSize),
-                    .compressedSize = static_cast<decltype(MDB::DataEntry::compressedSize)>(data->data.size()),
-                });
-
-                output.seekp(dataStart + offset);
-                output.write(data->data.data(), data->data.size());
-                offset += data->data.size();
-            }
         }
 
-        output.seekp(0);
-        typename MDB::Header header = {
+        const typename MDB::Header header = {
             .fileEntryCount = static_cast<decltype(MDB::Header::fileEntryCount)>(treeEntries.size()),
             .fileNameCount  = static_cast<decltype(MDB::Header::fileNameCount)>(nameEntries.size()),
             .dataEntryCount = static_cast<decltype(MDB::Header::dataEntryCount)>(dataEntries.size()),
             .dataStart      = static_cast<decltype(MDB::Header::dataStart)>(dataStart),
-            .totalSize      = static_cast<decltype(MDB::Header::totalSize)>(dataStart + offset),
+            .totalSize      = static_cast<decltype(MDB::Header::totalSize)>(totalSize),
+        };
+
+        std::vector<char> data;
+        auto append = [&](const auto* values, size_t count)
+        {
+            const auto* bytes = reinterpret_cast<const char*>(values);
+            data.insert(data.end(), bytes, bytes + count * sizeof(*values));
         };
+        append(&header, 1);
+        append(treeEntries.data(), treeEntries.size());
+        append(nameEntries.data(), nameEntries.size());
+        append(dataEntries.data(), dataEntries.size());
+        return data;
+    }
+
+    /**
+     * Writes an archive for the given files, ordered by path. Files with a base entry are copied from the base archive
+     * as they are stored, all other files are read from their path and compressed.
+     *
+     * When writing in place the target is the only base archive. Its data section is kept and new data gets appended
+     * to it.
+     *
+     * When splitting, the files are written in order and a new volume with its own file tree is started whenever the
+     * next file would exceed the file count or size limit of the archive format. The compression runs ahead across
+     * volume boundaries, so the sizes are known once a file is due to be written.
+     */
+    template<ArchiveType MDB>
+    auto writeArchive(const std::vector<TreeName>& files,
+                      std::span<ArchiveInfo<MDB>> bases,
+                      const std::filesystem::path& target,
+                      const PackOptions& options,
+                      bool inPlace) -> std::expected<void, std::string>
+    {
+        constexpr auto maxFiles = getMaxFileCount<MDB>();
+        constexpr auto maxSize  = getMaxArchiveSize<MDB>();
+        const auto compress     = options.compress;
+
+        // files in place can't be recompressed, as their data isn't rewritten
+        const auto recompress = options.recompress && !inPlace;
+        // an archive updated in place has to stay a single archive
+        const auto split = options.split && !inPlace;
+
+        if (options.reservedEntries >= maxFiles)
+            return std::unexpected(
+                std::format("Can't reserve room for {} files, the archive format supports {} files.",
+                            options.reservedEntries,
+                            maxFiles));
+
+        const auto volumeCapacity = maxFiles - options.reservedEntries;
+        if (!split && files.size() > volumeCapacity)
+            return std::unexpected(std::format("{} files exceed the {} files the archive format supports, use the "
+                                               "split option to spread them over multiple archives.",
+                                               files.size(),
+                                               volumeCapacity));
+
+        // the trees of the volumes of a split archive are only known once they are full
+        std::vector<TreeNode> tree;
+        std::vector<const TreeName*> order;
+        if (!split)
+        {
+            log("[Pack] Generating File Tree...");
+            tree = generateTree(files);
+        }
+
+        if (split || options.layout != DataLayout::TREE)
+            std::ranges::transform(files, std::back_inserter(order), [](const auto& file) { return &file; });
+        else
+        {
+            for (const auto& node : tree)
+                if (node.compareBit != std::numeric_limits<decltype(node.compareBit)>::max())
+                    order.push_back(&node.name);
+        }
+
+        auto sorted = sortFiles(order, options);
+        if (!sorted) return sorted;
+
+        // start compressing files
+        std::map<std::string, std::promise<std::expected<CompressionResult, std::string>>> futureMap;
+        // twice the core count to account for blocking threads
+        auto threadCount = std::thread::hardware_concurrency() * 2;
+        boost::asio::thread_pool pool(threadCount);
+        log(std::format("[Pack] Start compressing files with {} threads...", threadCount));
+
+        for (const auto* file : order)
+        {
+            if (file->baseEntry && !recompress) continue;
+
+            // map nodes are stable, so the workers don't have to look up the map while it's still being filled
+            auto& promise = futureMap[file->name];
+
+            auto lambda = [&, file]
+            {
+                promise.set_value(
+                    file->baseEntry
+                        ? getArchiveFileData(bases[file->baseArchive], file->baseEntry.value(), compress)
+                        : getFileData<typename MDB::Compressor>(file->path, compress));
+            };
+
+            boost::asio::post(pool, lambda);
+        }
+
+        std::vector<typename MDB::DataEntry> dataEntries;
+
+        size_t remaining = order.size();
+        auto fileCount   = std::min<uint64_t>(remaining, volumeCapacity);
+        auto dataStart   = alignUp(getDataStart<MDB>(fileCount + options.reservedEntries), options.alignment);
+        size_t offset    = 0;
+        auto openMode    = std::ios::out | std::ios::binary;
+        // the data section of an archive updated in place that has to make room for larger file tables
+        std::optional<std::pair<uint64_t, uint64_t>> movedData;
+
+        if (inPlace)
+        {
+            const auto& baseHeader = bases.front().getHeader();
+            offset                 = baseHeader.totalSize - baseHeader.dataStart;
+            openMode |= std::ios::in; // don't truncate the archive
+
+            // the data offsets are relative to the data section, so it can be moved without touching them.
+            // New data gets appended behind the moved section, which only happens once all files were written.
+            if (getDataStart<MDB>(fileCount) <= baseHeader.dataStart)
+                dataStart = baseHeader.dataStart;
+            else
+                movedData = {baseHeader.dataStart, baseHeader.totalSize};
+        }
+
+        size_t fileId = 0;
+        size_t volume = 0;
+        // CRC -> data ID of compressed files, for deduplication
+        std::map<uint64_t, size_t> dataMap;
+        // (base archive, offset) -> data ID, to keep the data sharing of the base archives
+        std::map<std::pair<size_t, uint64_t>, size_t> baseDataMap;
+        // (CRC, size) -> data copied from base archives, to share identical data of different base archives
+        std::multimap<std::pair<uint32_t, uint64_t>, std::pair<const TreeName*, size_t>> baseContentMap;
+        // name -> data ID of the files in the current volume
+        std::map<std::string, size_t> dataIds;
+        std::vector<TreeName> volumeFiles;
+        typename MDB::OutputStream output(target, openMode);
+
+        auto writeTables = [&](const std::vector<TreeNode>& volumeTree)
+        {
+            auto tables = getTableData<MDB>(volumeTree, dataIds, dataEntries, dataStart, dataStart + offset);
+            output.seekp(0);
+            output.write(tables.data(), static_cast<std::streamsize>(tables.size()));
+        };
+
+        auto nextVolume = [&]
+        {
+            log("[Pack] Generating File Tree...");
+            writeTables(generateTree(std::move(volumeFiles)));
+            output.close();
+
+            auto path = getVolumePath(target, ++volume);
+            log(std::format("[Pack] Archive is full, continuing with {}", path.string()));
+
+            fileCount = std::min<uint64_t>(remaining, volumeCapacity);
+            dataStart = alignUp(getDataStart<MDB>(fileCount + options.reservedEntries), options.alignment);
+            offset    = 0;
+            dataEntries.clear();
+            dataMap.clear();
+            baseDataMap.clear();
+            baseContentMap.clear();
+            dataIds.clear();
+            volumeFiles.clear();
+            output.open(path, openMode);
+        };
+
+        auto writeData = [&](const TreeName& name,
+                             std::vector<char>& data,
+                             uint64_t fullSize) -> std::expected<size_t, std::string>
+        {
+            if (fullSize > std::numeric_limits<decltype(MDB::DataEntry::fullSize)>::max())
+                return std::unexpected(std::format("File {} is too large for the archive format.", name.name));
+
+            // the padding in front of aligned data is left empty
+            auto start = alignUp(dataStart + offset, options.alignment) - dataStart;
+            if (dataStart + start + data.size() > maxSize)
+            {
+                if (!split)
+                    return std::unexpected(std::format("The archive exceeds the {} bytes the archive format supports "
+                                                       "at file {}, use the split option to spread the files over "
+                                                       "multiple archives.",
+                                                       maxSize,
+                                                       name.name));
+                if (!volumeFiles.empty()) nextVolume();
+                start = 0;
+                if (dataStart + data.size() > maxSize)
+                    return std::unexpected(std::format("File {} is too large for the archive format.", name.name));
+            }
+
+            dataEntries.push_back({
+                .offset         = static_cast<decltype(MDB::DataEntry::offset)>(start),
+                .fullSize       = static_cast<decltype(MDB::DataEntry::fullSize)>(fullSize),
+                .compressedSize = static_cast<decltype(MDB::DataEntry::compressedSize)>(data.size()),
+            });
+
+            output.seekp(dataStart + start);
+            output.write(data.data(), data.size());
+            offset = start + data.size();
+            return dataEntries.size() - 1;
+        };
+
+        auto getNewData = [&](const TreeName& name) -> std::expected<size_t, std::string>
+        {
+            auto data = futureMap[name.name].get_future().get();
+            if (!data) return std::unexpected(data.error());
+
+            auto dedup = compress == CompressMode::ADVANCED;
+            if (auto existing = dataMap.find(data->crc); dedup && existing != dataMap.end()) return existing->second;
+
+            auto dataId = writeData(name, data->data, data->originalSize);
+            if (dataId) dataMap[data->crc] = dataId.value();
+            return dataId;
+        };
+
+        auto getBaseData = [&](const TreeName& name) -> std::expected<size_t, std::string>
+        {
+            const auto& entry = name.baseEntry.value();
+            auto blobKey      = std::pair{name.baseArchive, entry.offset};
+
+            if (auto existing = baseDataMap.find(blobKey); existing != baseDataMap.end()) return existing->second;
+
+            if (inPlace)
+            {
+                // the data is already where it belongs
+                dataEntries.push_back({
+                    .offset         = static_cast<decltype(MDB::DataEntry::offset)>(entry.offset),
+                    .fullSize       = static_cast<decltype(MDB::DataEntry::fullSize)>(entry.fullSize),
+                    .compressedSize = static_cast<decltype(MDB::DataEntry::compressedSize)>(entry.compressedSize),
+                });
+                return baseDataMap[blobKey] = dataEntries.size() - 1;
+            }
+
+            // the data gets decrypted when reading and encrypted for the new offset when writing
+            auto raw = bases[name.baseArchive].readRawData(entry);
+            if (!raw) return std::unexpected(raw.error());
+
+            if (bases.size() == 1)
+            {
+                auto dataId = writeData(name, raw.value(), entry.fullSize);
+                if (dataId) baseDataMap[blobKey] = dataId.value();
+                return dataId;
+            }
+
+            // the CRC only finds candidates, the data is compared in full before sharing it
+            auto contentKey = std::pair{getChecksum(raw.value()), raw->size()};
+            auto [first, last] = baseContentMap.equal_range(contentKey);
+            for (const auto& [other, otherId] : std::ranges::subrange(first, last) | std::views::values)
+            {
+                if (other->baseEntry->fullSize != entry.fullSize) continue;
+
+                auto otherRaw = bases[other->baseArchive].readRawData(other->baseEntry.value());
+                if (!otherRaw) return std::unexpected(otherRaw.error());
+                if (otherRaw.value() == raw.value()) return baseDataMap[blobKey] = otherId;
+            }
+
+            auto dataId = writeData(name, raw.value(), entry.fullSize);
+            if (!dataId) return dataId;
+
+            baseContentMap.emplace(contentKey, std::pair{&name, dataId.value()});
+            return baseDataMap[blobKey] = dataId.value();
+        };
+
+        for (const auto* file : order)
+        {
+            if (split && volumeFiles.size() == fileCount) nextVolume();
+
+            if (fileId++ % 200 == 0) log(std::format("[Pack] Writing File {} of {}", fileId, order.size()));
+
+            // files from a base archive are only read once it's known that their data isn't shared
+            auto dataId = file->baseEntry && !recompress ? getBaseData(*file) : getNewData(*file);
+            if (!dataId)
+            {
+                // nothing of an archive updated in place has been touched yet, except for the appended data
+                if (inPlace)
+                {
+                    output.close();
+                    std::filesystem::resize_file(target, bases.front().getHeader().totalSize);
+                }
+                return std::unexpected(dataId.error());
+            }
+
+            dataIds[file->name] = dataId.value();
+            if (split) volumeFiles.push_back(*file);
+            remaining--;
+        }
+
+        if (split)
+        {
+            log("[Pack] Generating File Tree...");
+            tree = generateTree(std::move(volumeFiles));
+            if (volume > 0) log(std::format("[Pack] Split the files over {} archives.", volume + 1));
+        }
+
+        // volumes of an archive previously written to the target would otherwise mix with the new ones
+        if (!inPlace && std::filesystem::exists(getVolumePath(target, volume + 1)))
+        {
+            log("[Pack] Removing the volumes left over from the previous archive...");
+            removeVolumes(target, volume + 1);
+        }
 
-        output.write(reinterpret_cast<char*>(&header), headerSize);
-        output.write(reinterpret_cast<char*>(treeEntries.data()), treeEntries.size() * sizeof(typename MDB::TreeEntry));
-        output.write(reinterpret_cast<char*>(nameEntries.data()), nameEntries.size() * sizeof(typename MDB::NameEntry));
-        output.write(reinterpret_cast<char*>(dataEntries.data()), dataEntries.size() * sizeof(typename MDB::DataEntry));
+        if (movedData)
+        {
+            const auto [start, end] = movedData.value();
+            log(std::format("[Pack] File tables outgrew their space, moving data section by {} bytes...",
+                            dataStart - start));
+
+            output.flush();
+            auto result = moveData<MDB>(target, start, end, dataStart);
+            if (!result) return result;
+        }
+
+        writeTables(tree);
         return {};
     }
+
+    /**
+     * Estimates the size of an archive for the given files, see estimateArchive.
+     *
+     * Files copied from base archives have a known size. The others are grouped into strata by their extension and
+     * magnitude of size, of which a random sample gets compressed, at least 2 files and about 2% of the bytes per
+     * stratum. Files larger than a few blocks are only compressed in evenly spread blocks. The size of each stratum
+     * is extrapolated using the compression ratio of its sample (ratio estimator), the confidence interval follows
+     * from the variance of the sampled files around that ratio.
+     *
+     * With advanced compression, files of equal size get their checksum calculated to find the ones that get
+     * deduplicated.
+     */
+    template<ArchiveType MDB>
+    auto estimateFiles(const std::vector<TreeName>& files,
+                       std::span<ArchiveInfo<MDB>> bases,
+                       const PackOptions& options) -> std::expected<PackEstimate, std::string>
+    {
+        constexpr double SAMPLE_RATIO  = 0.02;
+        constexpr uint64_t BLOCK_SIZE  = 1024ULL * 1024;
+        constexpr uint64_t MIN_BLOCKS  = 4;
+        constexpr uint64_t BLOCK_LIMIT = 2 * MIN_BLOCKS * BLOCK_SIZE;
+        constexpr size_t MIN_SAMPLES   = 2;
+        constexpr double Z_95          = 1.96;
+
+        struct Unit
+        {
+            const TreeName* file;
+            uint64_t size;
+        };
+        struct Stratum
+        {
+            std::vector<Unit> units;
+            uint64_t size = 0;
+        };
+        struct Sample
+        {
+            Unit unit;
+            std::map<std::string, Stratum>::iterator stratum;
+            std::expected<uint64_t, std::string> compressedSize;
+            // variance of the compressed size when only blocks of the file got compressed
+            double variance = 0;
+        };
+
+        const auto compress   = options.compress;
+        const auto recompress = options.recompress;
+
+        PackEstimate estimate{
+            .fileCount    = files.size(),
+            .maxFileCount = getMaxFileCount<MDB>(),
+            .maxSize      = getMaxArchiveSize<MDB>(),
+        };
+        // size of the data that is known without compressing anything, with its alignment padding
+        uint64_t knownSize = 0;
+        // number of data blobs and the size of the largest one, for the space left at the end of split volumes
+        uint64_t dataCount   = 0;
+        uint64_t largestData = 0;
+
+        // (base archive, offset) of copied data, which is shared like in the base archives
+        std::set<std::pair<size_t, uint64_t>> baseData;
+        std::vector<Unit> units;
+
+        for (const auto& file : files)
+        {
+            if (file.baseEntry && !recompress)
+            {
+                if (baseData.emplace(file.baseArchive, file.baseEntry->offset).second)
+                {
+                    knownSize += alignUp(file.baseEntry->compressedSize, options.alignment);
+                    largestData = std::max<uint64_t>(largestData, file.baseEntry->compressedSize);
+                }
+                continue;
+            }
+
+            auto size = file.baseEntry ? file.baseEntry->fullSize : std::filesystem::file_size(file.path);
+            estimate.inputSize += size;
+            units.push_back({.file = &file, .size = size});
+        }
+
+        // only files of equal size can be identical, so only those need to be read to find duplicates
+        if (compress == CompressMode::ADVANCED)
+        {
+            std::map<uint64_t, size_t> sizeCount;
+            for (const auto& unit : units)
+                sizeCount[unit.size]++;
+
+            std::set<uint32_t> checksums;
+            auto isDuplicate = [&](const Unit& unit) -> bool
+            {
+                if (sizeCount[unit.size] < 2) return false;
+
+                auto data = unit.file->baseEntry
+                                ? getArchiveFileData(
+                                      bases[unit.file->baseArchive], unit.file->baseEntry.value(), CompressMode::NONE)
+                                : getFileData<typename MDB::Compressor>(unit.file->path, CompressMode::NONE);
+                return data && !checksums.insert(getChecksum(data->data)).second;
+            };
+
+            std::erase_if(units, isDuplicate);
+        }
+
+        dataCount = baseData.size() + units.size();
+        for (const auto& unit : units)
+            largestData = std::max(largestData, unit.size);
+
+        if (compress == CompressMode::NONE)
+        {
+            for (const auto& unit : units)
+                knownSize += alignUp(unit.size, options.alignment);
+            units.clear();
+        }
+
+        std::map<std::string, Stratum> strata;
+        uint64_t estimatedInput = 0;
+        for (const auto& unit : units)
+        {
+            // names start with the extension
+            auto key      = std::format("{}/{}", unit.file->name.substr(0, 4), std::bit_width(unit.size) / 4);
+            auto& stratum = strata[key];
+            stratum.units.push_back(unit);
+            stratum.size += unit.size;
+            estimatedInput += unit.size;
+        }
+
+        // a fixed seed, so estimating the same files gives the same result
+        std::mt19937_64 rng(files.size());
+        std::vector<Sample> samples;
+        for (auto itr = strata.begin(); itr != strata.end(); itr++)
+        {
+            auto& stratum = itr->second;
+            std::ranges::shuffle(stratum.units, rng);
+
+            uint64_t sampled = 0;
+            for (size_t i = 0; i < stratum.units.size(); i++)
+            {
+                if (i >= MIN_SAMPLES && sampled >= stratum.size * SAMPLE_RATIO) break;
+
+                samples.push_back({.unit = stratum.units[i], .stratum = itr, .compressedSize = 0});
+                sampled += stratum.units[i].size;
+            }
+        }
+
+        log(std::format("[Estimate] Compressing samples of {} of {} files with {} threads...",
+                        samples.size(),
+                        files.size(),
+                        getThreadCount()));
+
+        std::atomic<uint64_t> sampledSize = 0;
+
+        auto estimateSample = [&](size_t index)
+        {
+            auto& sample     = samples[index];
+            const auto& unit = sample.unit;
+
+            if (unit.file->baseEntry || unit.size <= BLOCK_LIMIT)
+            {
+                auto data = unit.file->baseEntry
+                                ? getArchiveFileData(
+                                      bases[unit.file->baseArchive], unit.file->baseEntry.value(), compress)
+                                : getFileData<typename MDB::Compressor>(unit.file->path, compress);
+                if (!data)
+                    sample.compressedSize = std::unexpected(data.error());
+                else
+                    sample.compressedSize = data->data.size();
+                sampledSize += unit.size;
+                return;
+            }
+
+            // the stored size of the blocks, scaled to the whole file
+            std::ifstream input(unit.file->path, std::ios::in | std::ios::binary);
+            auto blockCount =
+                std::max<uint64_t>(MIN_BLOCKS, static_cast<uint64_t>(unit.size * SAMPLE_RATIO / BLOCK_SIZE));
+            std::vector<uint64_t> stored;
+            uint64_t storedSum = 0;
+            std::vector<char> block(BLOCK_SIZE);
+            for (uint64_t i = 0; i < blockCount; i++)
+            {
+                input.seekg(static_cast<std::streamoff>((unit.size - BLOCK_SIZE) * i / (blockCount - 1)));
+                input.read(block.data(), static_cast<std::streamsize>(block.size()));
+                stored.push_back(compressData<typename MDB::Compressor>(block, compress).data.size());
+                storedSum += stored.back();
+            }
+            if (!input)
+            {
+                sample.compressedSize = std::unexpected(
+                    std::format("Error: something went wrong while reading {}", unit.file->path.string()));
+                return;
+            }
+
+            auto blocks      = static_cast<double>(blockCount);
+            auto totalBlocks = static_cast<double>(unit.size) / BLOCK_SIZE;
+            auto mean        = static_cast<double>(storedSum) / blocks;
+            double squares   = 0;
+            for (auto size : stored)
+                squares += (static_cast<double>(size) - mean) * (static_cast<double>(size) - mean);
+
+            sample.compressedSize = static_cast<uint64_t>(mean * totalBlocks);
+            sample.variance = totalBlocks * totalBlocks * (1 - blocks / totalBlocks) * squares / (blocks - 1) / blocks;
+            sampledSize += blockCount * BLOCK_SIZE;
+        };
+
+        parallelFor(samples.size(), estimateSample);
+
+        // ratio estimator per stratum, see https://en.wikipedia.org/wiki/Ratio_estimator
+        double estimatedSize = 0;
+        double variance      = 0;
+        for (auto itr = samples.begin(); itr != samples.end();)
+        {
+            auto end =
+                std::find_if(itr, samples.end(), [&](const auto& sample) { return sample.stratum != itr->stratum; });
+            std::span<Sample> stratumSamples(itr, end);
+            const auto& stratum = itr->stratum->second;
+            itr                 = end;
+
+            double inputSum      = 0;
+            double outputSum     = 0;
+            double blockVariance = 0;
+            for (const auto& sample : stratumSamples)
+            {
+                if (!sample.compressedSize) return std::unexpected(sample.compressedSize.error());
+                inputSum += static_cast<double>(sample.unit.size);
+                outputSum += static_cast<double>(sample.compressedSize.value());
+                blockVariance += sample.variance;
+            }
+
+            auto ratio       = inputSum == 0 ? 1.0 : outputSum / inputSum;
+            auto sampleCount = static_cast<double>(stratumSamples.size());
+            auto unitCount   = static_cast<double>(stratum.units.size());
+            estimatedSize += ratio * static_cast<double>(stratum.size);
+
+            // two-stage sampling, the uncertainty of the files sampled in blocks adds to the one between the files
+            variance += unitCount / sampleCount * blockVariance;
+            if (stratumSamples.size() < 2 || sampleCount == unitCount) continue;
+
+            double residuals = 0;
+            for (const auto& sample : stratumSamples)
+            {
+                auto residual = static_cast<double>(sample.compressedSize.value()) -
+                                ratio * static_cast<double>(sample.unit.size);
+                residuals += residual * residual;
+            }
+
+            variance += unitCount * unitCount * (1 - sampleCount / unitCount) * residuals /
+                        (sampleCount - 1) / sampleCount;
+        }
+
+        // files are never stored larger than they are
+        auto margin = Z_95 * std::sqrt(variance);
+        auto lower  = std::max(0.0, estimatedSize - margin);
+        auto upper  = std::min(static_cast<double>(estimatedInput), estimatedSize + margin);
+
+        // the padding behind compressed data depends on its size, so it's between none and a full alignment step
+        const auto padding = options.alignment == 0 ? 0.0 : static_cast<double>(options.alignment - 1);
+        const auto stored  = static_cast<double>(units.size());
+        const auto average =
+            dataCount == 0 ? 0.0 : (static_cast<double>(knownSize) + estimatedSize) / static_cast<double>(dataCount);
+
+        // Every volume of a split archive has file tables of its own, with room for all files that are still left
+        // when it's started. A volume is full once the next file doesn't fit anymore, which leaves some room unused.
+        // The last data of a volume isn't padded.
+        auto getArchiveSize = [&](double dataSize, double unused, double lastPadding) -> std::pair<uint64_t, uint64_t>
+        {
+            const auto data      = static_cast<double>(knownSize) + dataSize;
+            const auto fileCount = static_cast<uint64_t>(files.size());
+            const auto maxSize   = static_cast<double>(estimate.maxSize);
+            const auto capacity  = estimate.maxFileCount - std::min(options.reservedEntries, estimate.maxFileCount - 1);
+
+            uint64_t volumes = 1;
+            if (options.split)
+                volumes = std::max({volumes,
+                                    (fileCount + capacity - 1) / capacity,
+                                    static_cast<uint64_t>(std::ceil(data / maxSize))});
+
+            // volumes are filled one after another, so all but the last one hold as many files as fit
+            auto volumeFiles = capacity;
+            if (data > 0)
+            {
+                auto fitting = std::ceil(static_cast<double>(fileCount) * std::max(0.0, maxSize - unused) / data);
+                volumeFiles  = std::clamp<uint64_t>(static_cast<uint64_t>(fitting), 1, capacity);
+            }
+
+            while (true)
+            {
+                uint64_t tableSize = 0;
+                for (uint64_t i = 0; i < volumes; i++)
+                {
+                    auto remaining = std::min(fileCount - std::min(fileCount, i * volumeFiles), capacity);
+                    tableSize += alignUp(getDataStart<MDB>(remaining + options.reservedEntries), options.alignment);
+                }
+
+                auto size = static_cast<double>(tableSize) + data - (static_cast<double>(volumes) * lastPadding);
+                if (!options.split || volumes >= fileCount ||
+                    size + (static_cast<double>(volumes - 1) * unused) <= static_cast<double>(volumes) * maxSize)
+                    return {static_cast<uint64_t>(std::llround(std::max(0.0, size))), volumes};
+                volumes++;
+            }
+        };
+
+        auto [estimatedTotal, volumeCount] =
+            getArchiveSize(estimatedSize + (stored * padding / 2), average / 2, padding / 2);
+        auto [upperTotal, upperVolumeCount] =
+            getArchiveSize(upper + (stored * padding), static_cast<double>(largestData), 0);
+
+        estimate.sampledSize      = sampledSize;
+        estimate.estimatedSize    = estimatedTotal;
+        estimate.lowerSize        = getArchiveSize(lower, 0, padding).first;
+        estimate.upperSize        = upperTotal;
+        estimate.volumeCount      = volumeCount;
+        estimate.upperVolumeCount = upperVolumeCount;
+        return estimate;
+    }
 } // namespace mvgltools::mdb1
\ No newline at end of file
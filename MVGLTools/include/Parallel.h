@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace mvgltools
+{
+    /**
+     * Gets the number of threads of the shared thread pool, one per core.
+     */
+    auto getThreadCount() -> size_t;
+
+    /**
+     * Runs a task on the thread pool shared by the tools.
+     */
+    void postTask(std::function<void()> task);
+
+    /**
+     * Calls function(i) for every i in [0, count) on the shared thread pool and returns once all calls are done.
+     * The calling thread works on the calls as well, so calls can use parallelFor themselves without starving the pool,
+     * e.g. to process the tables of files that are processed in parallel.
+     * If a call throws, the first exception is rethrown once all calls are done.
+     */
+    template<typename Function>
+    void parallelFor(size_t count, const Function& function)
+    {
+        struct State
+        {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+            std::exception_ptr error;
+        };
+
+        if (count == 0) return;
+
+        // helpers that start after all calls got claimed return without touching function
+        auto state = std::make_shared<State>();
+        auto work  = [state, count, &function]
+        {
+            for (auto i = state->next++; i < count; i = state->next++)
+            {
+                try
+                {
+                    function(i);
+                }
+                catch (...)
+                {
+                    const std::lock_guard lock(state->mutex);
+                    if (!state->error) state->error = std::current_exception();
+                }
+
+                if (++state->done != count) continue;
+
+                const std::lock_guard lock(state->mutex);
+                state->finished.notify_all();
+            }
+        };
+
+        for (size_t i = 1; i < std::min(count, getThreadCount()); i++)
+            postTask(work);
+        work();
+
+        std::unique_lock lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done == count; });
+        if (state->error) std::rethrow_exception(state->error);
+    }
+} // namespace mvgltools
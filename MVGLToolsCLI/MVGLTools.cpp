@@ -1,7 +1,9 @@
 #include "AFS2.h"
+#include "ByteSource.h"
 #include "EXPA.h"
 #include "Helpers.h"
 #include "MDB1.h"
+#include "Parallel.h"
 #include "SaveFile.h"
 
 #include <boost/any.hpp>
@@ -14,16 +16,21 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree_fwd.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cctype>
+#include <chrono>
 #include <concepts>
+#include <cstdint>
 #include <exception>
 #include <expected>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <optional>
 #include <ranges>
 #include <string>
 #include <vector>
@@ -45,6 +52,12 @@ namespace
         PACK_MVGL,
         UNPACK_MVGL,
         UNPACK_MVGL_FILE,
+        BENCHMARK_MVGL,
+        UPDATE_MVGL,
+        COMPACT_MVGL,
+        MERGE_MVGL,
+        RECOMPRESS_MVGL,
+        CONVERT_MVGL,
 
         PACK_MBE,
         PACK_MBE_DIR,
@@ -82,6 +95,11 @@ namespace
         { T::decrypt(source, target) } -> std::same_as<std::expected<void, std::string>>;
     };
 
+    template<typename T>
+    concept ConvertModule = requires(const std::filesystem::path& source, const std::filesystem::path& target) {
+        { T::convert(source, target) } -> std::same_as<std::expected<void, std::string>>;
+    };
+
     template<typename T>
     concept GameModules =
         requires() {
@@ -90,9 +108,10 @@ namespace
             typename T::CryptModule;
             typename T::SaveCryptModule;
             typename T::AFS2Module;
+            typename T::ConvertModule;
         } && mvgltools::mdb1::ArchiveType<typename T::MDB1Module> && mvgltools::expa::EXPA<typename T::EXPAModule> &&
         FileCryptModule<typename T::CryptModule> && SaveCryptModule<typename T::SaveCryptModule> &&
-        AFS2Module<typename T::AFS2Module>;
+        AFS2Module<typename T::AFS2Module> && ConvertModule<typename T::ConvertModule>;
 
     struct DummySaveCryptor
     {
@@ -268,6 +287,25 @@ namespace
         }
     };
 
+    struct DummyMDB1Converter
+    {
+        static auto convert([[maybe_unused]] const std::filesystem::path& source,
+                            [[maybe_unused]] const std::filesystem::path& target) -> std::expected<void, std::string>
+        {
+            return std::unexpected("Not supported");
+        }
+    };
+
+    template<mvgltools::mdb1::ArchiveType From, mvgltools::mdb1::ArchiveType To>
+    struct MDB1Converter
+    {
+        static auto convert(const std::filesystem::path& source, const std::filesystem::path& target)
+            -> std::expected<void, std::string>
+        {
+            return mvgltools::mdb1::convertArchive<From, To>(source, target);
+        }
+    };
+
     struct DSTSModule
     {
         using MDB1Module      = mvgltools::mdb1::DSTS;
@@ -275,6 +313,7 @@ namespace
         using CryptModule     = DummyFileCryptor;
         using SaveCryptModule = AESSaveCryptor;
         using AFS2Module      = DummyAFS2Packer;
+        using ConvertModule   = DummyMDB1Converter;
     };
 
     struct THLModule
@@ -284,6 +323,7 @@ namespace
         using CryptModule     = DummyFileCryptor;
         using SaveCryptModule = AESSaveCryptor;
         using AFS2Module      = DummyAFS2Packer;
+        using ConvertModule   = DummyMDB1Converter;
     };
 
     struct DSCSModule
@@ -293,6 +333,7 @@ namespace
         using CryptModule     = DSCSFileCryptor;
         using SaveCryptModule = DSCSSaveCryptor;
         using AFS2Module      = DSCSAFS2Packer;
+        using ConvertModule   = MDB1Converter<mvgltools::mdb1::DSCS, mvgltools::mdb1::DSCSNoCrypt>;
     };
 
     struct DSCSConsoleModule
@@ -302,16 +343,97 @@ namespace
         using CryptModule     = DSCSFileCryptor;
         using SaveCryptModule = DSCSSaveCryptor;
         using AFS2Module      = DSCSAFS2Packer;
+        using ConvertModule   = MDB1Converter<mvgltools::mdb1::DSCSNoCrypt, mvgltools::mdb1::DSCS>;
     };
 
     template<GameModules T>
     struct GameCLI
     {
-        static void packMVGL(const std::filesystem::path& source,
+        static void packMVGL(const std::vector<std::filesystem::path>& sources,
                              const std::filesystem::path& target,
-                             mvgltools::mdb1::CompressMode compress)
+                             const mvgltools::mdb1::PackOptions& options)
         {
-            auto result = mvgltools::mdb1::packArchive<typename T::MDB1Module>(source, target, compress);
+            auto result = mvgltools::mdb1::packArchive<typename T::MDB1Module>(sources, target, options);
+            if (!result) std::cout << result.error() << "\n";
+        }
+        static void packMVGL(const std::filesystem::path& base,
+                             const std::vector<std::filesystem::path>& sources,
+                             const std::filesystem::path& target,
+                             const mvgltools::mdb1::PackOptions& options)
+        {
+            auto result = mvgltools::mdb1::packArchive<typename T::MDB1Module>(base, sources, target, options);
+            if (!result) std::cout << result.error() << "\n";
+        }
+        static void estimateMVGL(const std::expected<mvgltools::mdb1::PackEstimate, std::string>& result)
+        {
+            if (!result)
+            {
+                std::cout << result.error() << "\n";
+                return;
+            }
+
+            constexpr double MIB = 1024.0 * 1024.0;
+            const auto& estimate = result.value();
+
+            mvgltools::log(std::format("[Estimate] {} files, {:.1f} MiB uncompressed, {:.1f} MiB compressed as sample",
+                                       estimate.fileCount,
+                                       estimate.inputSize / MIB,
+                                       estimate.sampledSize / MIB));
+            mvgltools::log(std::format("[Estimate] Archive size: {:.1f} MiB (95% confidence: {:.1f} - {:.1f} MiB)",
+                                       estimate.estimatedSize / MIB,
+                                       estimate.lowerSize / MIB,
+                                       estimate.upperSize / MIB));
+
+            std::string verdict = "The archive fits within the limits of the format.";
+            if (estimate.upperVolumeCount > 1)
+                verdict = estimate.volumeCount == estimate.upperVolumeCount
+                              ? std::format("The files get split over {} archives.", estimate.volumeCount)
+                              : std::format("The files get split over {} to {} archives.",
+                                            estimate.volumeCount,
+                                            estimate.upperVolumeCount);
+            else if (estimate.fileCount > estimate.maxFileCount)
+                verdict = std::format("The archive exceeds the format's limit of {} files, use --split.",
+                                      estimate.maxFileCount);
+            else if (estimate.lowerSize > estimate.maxSize)
+                verdict = std::format("The archive exceeds the format's limit of {:.1f} MiB, use --split.",
+                                      estimate.maxSize / MIB);
+            else if (estimate.upperSize > estimate.maxSize)
+                verdict =
+                    std::format("The archive might exceed the format's limit of {:.1f} MiB.", estimate.maxSize / MIB);
+
+            mvgltools::log("[Estimate] " + verdict);
+        }
+        static void updateMVGL(const std::vector<std::filesystem::path>& sources,
+                               const std::filesystem::path& target,
+                               const mvgltools::mdb1::PackOptions& options)
+        {
+            auto result = mvgltools::mdb1::updateArchive<typename T::MDB1Module>(target, sources, options);
+            if (!result) std::cout << result.error() << "\n";
+        }
+        static void mergeMVGL(const std::vector<std::filesystem::path>& sources,
+                              const std::filesystem::path& target,
+                              const mvgltools::mdb1::PackOptions& options)
+        {
+            auto result = mvgltools::mdb1::mergeArchives<typename T::MDB1Module>(sources, target, options);
+            if (!result) std::cout << result.error() << "\n";
+        }
+        static void recompressMVGL(const std::filesystem::path& source,
+                                   const std::filesystem::path& target,
+                                   const mvgltools::mdb1::PackOptions& options)
+        {
+            auto result = mvgltools::mdb1::recompressArchive<typename T::MDB1Module>(source, target, options);
+            if (!result) std::cout << result.error() << "\n";
+        }
+        static void convertMVGL(const std::filesystem::path& source, const std::filesystem::path& target)
+        {
+            auto result = T::ConvertModule::convert(source, target);
+            if (!result) std::cout << result.error() << "\n";
+        }
+        static void compactMVGL(const std::filesystem::path& source,
+                                const std::filesystem::path& target,
+                                const mvgltools::mdb1::PackOptions& options)
+        {
+            auto result = mvgltools::mdb1::compactArchive<typename T::MDB1Module>(source, target, options);
             if (!result) std::cout << result.error() << "\n";
         }
         static void unpackMVGL(const std::filesystem::path& source, const std::filesystem::path& target)
@@ -329,32 +451,154 @@ namespace
             if (!result) std::cout << result.error() << "\n";
         }
 
-        static void unpackMBE(const std::filesystem::path& source, const std::filesystem::path& target)
+        static void benchmarkMVGL(const std::filesystem::path& source, const std::filesystem::path& target)
         {
-            std::cout << source << "\n";
-            auto result = mvgltools::expa::readEXPA<typename T::EXPAModule>(source);
-            if (!result)
+            using Compressor = typename T::MDB1Module::Compressor;
+            using Clock      = std::chrono::steady_clock;
+            using Seconds    = std::chrono::duration<double>;
+
+            struct BenchmarkResult
             {
-                std::cout << result.error() << "\n";
-                return;
+                std::string name;
+                uint64_t inputSize{};
+                uint64_t outputSize{};
+                Seconds time{};
+            };
+
+            constexpr std::array levels = {
+                mvgltools::CompressionLevel::FAST,
+                mvgltools::CompressionLevel::BALANCED,
+                mvgltools::CompressionLevel::BEST,
+            };
+            std::array<BenchmarkResult, levels.size() + 2> results{{
+                {.name = "read"},
+                {.name = "decompress"},
+                {.name = "compress fast"},
+                {.name = "compress balanced"},
+                {.name = "compress best"},
+            }};
+
+            mvgltools::mdb1::ArchiveInfo<typename T::MDB1Module> archive(source);
+            const auto& entries = archive.getEntries();
+
+            auto fileId = 0;
+            for (const auto& [name, entry] : entries)
+            {
+                if (fileId++ % 200 == 0)
+                    mvgltools::log(std::format("[Benchmark] Processing File {} of {}", fileId, entries.size()));
+
+                // files are read in the order they get extracted, so the layout of the archive shows
+                auto start = Clock::now();
+                auto raw   = archive.readRawData(entry);
+                results[0].time += Clock::now() - start;
+                if (!raw)
+                {
+                    std::cout << raw.error() << "\n";
+                    return;
+                }
+                results[0].inputSize += raw->size();
+                results[0].outputSize += raw->size();
+
+                start     = Clock::now();
+                auto data = Compressor::decompress(raw.value(), entry.fullSize);
+                results[1].time += Clock::now() - start;
+                if (!data)
+                {
+                    std::cout << data.error() << "\n";
+                    return;
+                }
+                results[1].inputSize += raw->size();
+                results[1].outputSize += data->size();
+
+                if (data->empty()) continue;
+
+                for (size_t i = 0; i < levels.size(); i++)
+                {
+                    start           = Clock::now();
+                    auto compressed = Compressor::compress(data.value(), levels[i]);
+                    results[i + 2].time += Clock::now() - start;
+                    if (!compressed)
+                    {
+                        std::cout << compressed.error() << "\n";
+                        return;
+                    }
+                    results[i + 2].inputSize += data->size();
+                    results[i + 2].outputSize += compressed->size();
+                }
             }
 
-            auto result2 = mvgltools::expa::exportCSV(result.value(), target / source.filename());
-            if (!result2) std::cout << result2.error() << "\n";
+            std::ofstream report(target);
+            report << "operation,input bytes,output bytes,ratio,MB/s\n";
+            for (const auto& result : results)
+            {
+                auto ratio = result.inputSize == 0 ? 0.0 : static_cast<double>(result.outputSize) / result.inputSize;
+                auto speed = result.time.count() == 0 ? 0.0 : result.inputSize / result.time.count() / 1000000.0;
+                auto line =
+                    std::format("{},{},{},{:.4f},{:.2f}", result.name, result.inputSize, result.outputSize, ratio, speed);
+                mvgltools::log(line);
+                report << line << "\n";
+            }
         }
 
-        static void packMBE(const std::filesystem::path& source, const std::filesystem::path& target)
+        static auto exportMBE(const std::filesystem::path& source, const std::filesystem::path& target)
+            -> std::expected<void, std::string>
+        {
+            auto result = mvgltools::expa::readEXPA<typename T::EXPAModule>(source);
+            if (!result) return std::unexpected(result.error());
+
+            return mvgltools::expa::exportCSV(result.value(), target / source.filename());
+        }
+
+        static auto importMBE(const std::filesystem::path& source, const std::filesystem::path& target)
+            -> std::expected<void, std::string>
         {
-            std::cout << source << "\n";
             auto result = mvgltools::expa::importCSV<typename T::EXPAModule>(source);
-            if (!result)
+            if (!result) return std::unexpected(result.error());
+
+            return mvgltools::expa::writeEXPA<typename T::EXPAModule>(result.value(), target);
+        }
+
+        /**
+         * Runs job for every file on the shared thread pool. The files and their errors are printed once all jobs
+         * are done, in the order of the files.
+         */
+        template<typename Job>
+        static void processFiles(const std::vector<std::filesystem::path>& files, const Job& job)
+        {
+            std::vector<std::expected<void, std::string>> results(files.size());
+            auto process = [&](size_t i)
             {
-                std::cout << result.error() << "\n";
-                return;
+                // an exception only fails the file it came from, the others still get processed
+                try
+                {
+                    results[i] = job(files[i]);
+                }
+                catch (const std::exception& ex)
+                {
+                    results[i] = std::unexpected(std::format("Error: {}", ex.what()));
+                }
+            };
+            mvgltools::parallelFor(files.size(), process);
+
+            for (size_t i = 0; i < files.size(); i++)
+            {
+                std::cout << files[i] << "\n";
+                if (!results[i]) std::cout << results[i].error() << "\n";
             }
+        }
+
+        static void unpackMBE(const std::filesystem::path& source, const std::filesystem::path& target)
+        {
+            std::cout << source << "\n";
+            auto result = exportMBE(source, target);
+            if (!result) std::cout << result.error() << "\n";
+        }
 
-            auto result2 = mvgltools::expa::writeEXPA<typename T::EXPAModule>(result.value(), target);
-            if (!result2) std::cout << result2.error() << "\n";
+        static void packMBE(const std::filesystem::path& source, const std::filesystem::path& target)
+        {
+            std::cout << source << "\n";
+            auto result = importMBE(source, target);
+            if (!result) std::cout << result.error() << "\n";
         }
 
         static void unpackMBEDir(const std::filesystem::path& source, const std::filesystem::path& target)
@@ -365,9 +609,12 @@ namespace
             std::filesystem::create_directories(target);
 
             const std::filesystem::directory_iterator itr(source);
-
+            std::vector<std::filesystem::path> files;
             for (const auto& file : itr)
-                if (file.is_regular_file()) unpackMBE(file, target);
+                if (file.is_regular_file()) files.push_back(file.path());
+            std::ranges::sort(files);
+
+            processFiles(files, [&](const auto& file) { return exportMBE(file, target); });
         }
 
         static void packMBEDir(const std::filesystem::path& source, const std::filesystem::path& target)
@@ -378,9 +625,35 @@ namespace
             std::filesystem::create_directories(target);
 
             const std::filesystem::directory_iterator itr(source);
-
+            std::vector<std::filesystem::path> files;
             for (const auto& file : itr)
-                if (file.is_directory()) packMBE(file.path(), target / file.path().filename());
+                if (file.is_directory()) files.push_back(file.path());
+            std::ranges::sort(files);
+
+            processFiles(files, [&](const auto& file) { return importMBE(file, target / file.filename()); });
+        }
+
+        static auto getMBEStructure(const std::filesystem::path& file) -> std::optional<boost::property_tree::ptree>
+        {
+            // only the table directory is needed, so no values get decoded
+            const mvgltools::MappedSource source(file);
+            if (!source) return std::nullopt;
+
+            auto view = mvgltools::expa::readEXPAView<typename T::EXPAModule>(source.data(), file);
+            if (!view) return std::nullopt;
+
+            boost::property_tree::ptree structure;
+            for (size_t i = 0; i < view->getTableCount(); i++)
+            {
+                boost::property_tree::ptree tableTree;
+
+                for (const auto& entry : view->getTableStructure(i).getStructure())
+                    tableTree.add(entry.name, mvgltools::expa::detail::toString(entry.type));
+
+                structure.add_child(std::string(view->getTableName(i)), tableTree);
+            }
+
+            return structure;
         }
 
         static void dumpMBEStructures([[maybe_unused]] const std::filesystem::path& source,
@@ -392,33 +665,44 @@ namespace
             std::filesystem::create_directories(target);
 
             const std::filesystem::recursive_directory_iterator itr(source);
-
-            boost::property_tree::ptree structureMap;
-
+            std::vector<std::filesystem::path> files;
             for (const auto& file : itr)
             {
-                if (!file.is_regular_file() && file.path().extension() != "mbe") continue;
-
-                auto table = mvgltools::expa::readEXPA<typename T::EXPAModule>(file);
-                if (!table) continue;
-
-                auto jsonName = std::format("{}.json", file.path().filename().string());
-                auto path     = boost::property_tree::ptree::path_type{file.path().filename().stem().string(), '\\'};
-                structureMap.add(path, jsonName);
+                if (!file.is_regular_file() || file.path().extension() != ".mbe") continue;
+                files.push_back(file.path());
+            }
+            // sorted, so files with the same name always get written in the same order
+            std::ranges::sort(files);
 
-                boost::property_tree::ptree structure;
-                for (const auto& table : table.value().tables)
+            // read in parallel, written in order
+            std::vector<std::optional<boost::property_tree::ptree>> structures(files.size());
+            auto readStructure = [&](size_t i)
+            {
+                // a broken file is left out, the others still get dumped
+                try
+                {
+                    structures[i] = getMBEStructure(files[i]);
+                }
+                catch (const std::exception& ex)
                 {
-                    boost::property_tree::ptree tableTree;
+                    mvgltools::log(std::format("Error: failed to read {}: {}", files[i].string(), ex.what()));
+                }
+            };
+            mvgltools::parallelFor(files.size(), readStructure);
 
-                    for (const auto& entry : table.structure.getStructure())
-                        tableTree.add(entry.name, mvgltools::expa::detail::toString(entry.type));
+            boost::property_tree::ptree structureMap;
 
-                    structure.add_child(table.name, tableTree);
-                }
+            for (size_t i = 0; i < files.size(); i++)
+            {
+                if (!structures[i]) continue;
+
+                const auto& file = files[i];
+                auto jsonName    = std::format("{}.json", file.filename().string());
+                auto path        = boost::property_tree::ptree::path_type{file.filename().stem().string(), '\\'};
+                structureMap.add(path, jsonName);
 
                 std::ofstream fileFile(target / jsonName);
-                boost::property_tree::write_json(fileFile, structure);
+                boost::property_tree::write_json(fileFile, structures[i].value());
             }
 
             structureMap.sort();
@@ -468,15 +752,48 @@ namespace
             const std::filesystem::path source = vm["input"].as<std::string>();
             const std::filesystem::path target = vm["output"].as<std::string>();
 
+            const mvgltools::mdb1::PackOptions packOptions = {
+                .compress        = vm["compress"].as<mvgltools::mdb1::CompressMode>(),
+                .reservedEntries = vm.contains("reserve") ? vm["reserve"].as<uint64_t>() : 0,
+                .split           = vm.contains("split"),
+                .layout          = vm.contains("layout") ? vm["layout"].as<mvgltools::mdb1::DataLayout>()
+                                                         : mvgltools::mdb1::DataLayout::TREE,
+                .accessLog       = vm.contains("access-log") ? vm["access-log"].as<std::string>() : "",
+                .alignment       = vm.contains("align") ? vm["align"].as<uint64_t>() : 0,
+            };
+
+            // the input followed by the overlays, later ones replace files of earlier ones
+            std::vector<std::filesystem::path> packSources = {source};
+            if (vm.contains("overlay"))
+                std::ranges::copy(vm["overlay"].as<std::vector<std::string>>(), std::back_inserter(packSources));
+
+            std::vector<std::filesystem::path> mergeSources = {source};
+            if (vm.contains("archive"))
+                std::ranges::copy(vm["archive"].as<std::vector<std::string>>(), std::back_inserter(mergeSources));
+
             switch (mode)
             {
                 case Mode::PACK_MVGL:
                 {
-                    auto compress = vm["compress"].as<mvgltools::mdb1::CompressMode>();
-                    packMVGL(source, target, compress);
+                    using MDB = typename T::MDB1Module;
+                    if (vm.contains("dry-run") && vm.contains("base"))
+                        estimateMVGL(mvgltools::mdb1::estimateArchive<MDB>(
+                            vm["base"].as<std::string>(), packSources, packOptions));
+                    else if (vm.contains("dry-run"))
+                        estimateMVGL(mvgltools::mdb1::estimateArchive<MDB>(packSources, packOptions));
+                    else if (vm.contains("base"))
+                        packMVGL(vm["base"].as<std::string>(), packSources, target, packOptions);
+                    else
+                        packMVGL(packSources, target, packOptions);
                     break;
                 }
+                case Mode::UPDATE_MVGL: updateMVGL(packSources, target, packOptions); break;
+                case Mode::COMPACT_MVGL: compactMVGL(source, target, packOptions); break;
+                case Mode::MERGE_MVGL: mergeMVGL(mergeSources, target, packOptions); break;
+                case Mode::RECOMPRESS_MVGL: recompressMVGL(source, target, packOptions); break;
+                case Mode::CONVERT_MVGL: convertMVGL(source, target); break;
                 case Mode::UNPACK_MVGL: unpackMVGL(source, target); break;
+                case Mode::BENCHMARK_MVGL: benchmarkMVGL(source, target); break;
                 case Mode::UNPACK_MVGL_FILE:
                 {
                     auto file = vm["file"].as<std::string>();
@@ -513,6 +830,30 @@ namespace
         map["extractmvgl"]  = Mode::UNPACK_MVGL;
         map["extract-mvgl"] = Mode::UNPACK_MVGL;
 
+        map["update"]      = Mode::UPDATE_MVGL;
+        map["updatemvgl"]  = Mode::UPDATE_MVGL;
+        map["update-mvgl"] = Mode::UPDATE_MVGL;
+
+        map["compact"]      = Mode::COMPACT_MVGL;
+        map["compactmvgl"]  = Mode::COMPACT_MVGL;
+        map["compact-mvgl"] = Mode::COMPACT_MVGL;
+
+        map["merge"]      = Mode::MERGE_MVGL;
+        map["mergemvgl"]  = Mode::MERGE_MVGL;
+        map["merge-mvgl"] = Mode::MERGE_MVGL;
+
+        map["recompress"]      = Mode::RECOMPRESS_MVGL;
+        map["recompressmvgl"]  = Mode::RECOMPRESS_MVGL;
+        map["recompress-mvgl"] = Mode::RECOMPRESS_MVGL;
+
+        map["convert"]      = Mode::CONVERT_MVGL;
+        map["convertmvgl"]  = Mode::CONVERT_MVGL;
+        map["convert-mvgl"] = Mode::CONVERT_MVGL;
+
+        map["benchmark"]      = Mode::BENCHMARK_MVGL;
+        map["benchmarkmvgl"]  = Mode::BENCHMARK_MVGL;
+        map["benchmark-mvgl"] = Mode::BENCHMARK_MVGL;
+
         map["unpackfile"]        = Mode::UNPACK_MVGL_FILE;
         map["unpackmvglfile"]    = Mode::UNPACK_MVGL_FILE;
         map["unpack-mvgl-file"]  = Mode::UNPACK_MVGL_FILE;
@@ -592,6 +933,20 @@ namespace
         map["normal"]   = mvgltools::mdb1::CompressMode::NORMAL;
         map["none"]     = mvgltools::mdb1::CompressMode::NONE;
         map["advanced"] = mvgltools::mdb1::CompressMode::ADVANCED;
+        map["fast"]     = mvgltools::mdb1::CompressMode::FAST;
+        map["greedy"]   = mvgltools::mdb1::CompressMode::FAST;
+        map["balanced"] = mvgltools::mdb1::CompressMode::BALANCED;
+        map["lazy"]     = mvgltools::mdb1::CompressMode::BALANCED;
+        return map;
+    }
+
+    auto getLayoutMap() -> std::map<std::string, mvgltools::mdb1::DataLayout>
+    {
+        std::map<std::string, mvgltools::mdb1::DataLayout> map;
+        map["tree"]   = mvgltools::mdb1::DataLayout::TREE;
+        map["path"]   = mvgltools::mdb1::DataLayout::PATH;
+        map["size"]   = mvgltools::mdb1::DataLayout::SIZE;
+        map["access"] = mvgltools::mdb1::DataLayout::ACCESS;
         return map;
     }
 
@@ -633,6 +988,13 @@ namespace mvgltools::mdb1
         static const std::map<std::string, CompressMode> map = getCompressionMap();
         validate_helper(value, values, map);
     }
+
+    // NOLINTNEXTLINE(misc-use-internal-linkage)
+    void validate(boost::any& value, const std::vector<std::string>& values, DataLayout* /*unused*/, int /*unused*/)
+    {
+        static const std::map<std::string, DataLayout> map = getLayoutMap();
+        validate_helper(value, values, map);
+    }
 } // namespace mvgltools::mdb1
 
 auto main(int argc, char** argv) -> int
@@ -649,9 +1011,15 @@ auto main(int argc, char** argv) -> int
     base_options("game,g", po::value<GameMode>()->required(), "Valid: dscs, dsts, thl, dscs-console");
     base_options("mode,m",
                  po::value<Mode>()->required(),
-                 "pack-mvgl        -> folder in, file out\n"
+                 "pack-mvgl        -> folder/manifest in, file out\n"
                  "unpack-mvgl      -> file in, folder out\n"
                  "unpack-mvgl-file -> file in, file out\n"
+                 "update-mvgl      -> folder/manifest in, file out (updated in place)\n"
+                 "compact-mvgl     -> file in, file out (can be the same)\n"
+                 "merge-mvgl       -> file in, file out (more files with --archive)\n"
+                 "recompress-mvgl  -> file in, file out (can be the same)\n"
+                 "convert-mvgl     -> file in, file out (dscs <-> dscs-console)\n"
+                 "benchmark-mvgl   -> file in, file out (CSV report)\n"
                  "pack-mbe         -> folder in, file out\n"
                  "unpack-mbe       -> file in, folder out\n"
                  "pack-mbe-dir     -> folder in, folder out\n"
@@ -673,7 +1041,7 @@ auto main(int argc, char** argv) -> int
     pos.add("output", 1);
 
     po::options_description pack_desc(
-        "MVGL Pack Options\n  Input: Root folder to pack\n  Output: Path of the packed file",
+        "MVGL Pack Options\n  Input: Root folder or manifest to pack\n  Output: Path of the packed file",
         120);
     auto pack_options = pack_desc.add_options();
     pack_options(
@@ -681,7 +1049,44 @@ auto main(int argc, char** argv) -> int
         po::value<mvgltools::mdb1::CompressMode>()->default_value(mvgltools::mdb1::CompressMode::NORMAL, "normal"),
         "normal   -> use regular compression, as in vanilla files\n"
         "none     -> use no compression\n"
-        "advanced -> improve compression by deduplicating, slower");
+        "advanced -> improve compression by deduplicating, slower\n"
+        "fast     -> use greedy compression, much faster, larger files\n"
+        "balanced -> use lazy compression with a limited search, faster");
+    pack_options("base",
+                 po::value<std::string>(),
+                 "an existing archive to use as base, the input folder replaces or adds files.\n"
+                 "Unchanged files are copied without recompressing them.");
+    pack_options("overlay",
+                 po::value<std::vector<std::string>>()->composing(),
+                 "additional folders or manifests to pack, can be given multiple times.\n"
+                 "Files of later ones replace files of earlier ones, starting with the input.");
+    pack_options("archive",
+                 po::value<std::vector<std::string>>()->composing(),
+                 "for merge-mvgl, additional archives to merge, can be given multiple times.\n"
+                 "Files of later ones replace files of earlier ones, starting with the input.");
+    pack_options("reserve",
+                 po::value<uint64_t>(),
+                 "number of additional files to reserve room for in the file tables,\n"
+                 "so update-mvgl can add them without moving the data section");
+    pack_options("dry-run",
+                 "for pack-mvgl, estimate the size of the archive by compressing a sample of the files,\n"
+                 "instead of packing it");
+    pack_options("split",
+                 "spread the files over multiple archives (name.1.mvgl, ...) if they exceed\n"
+                 "the file count or size limits of the archive format, instead of failing");
+    pack_options("layout",
+                 po::value<mvgltools::mdb1::DataLayout>(),
+                 "order of the file data in the archive\n"
+                 "tree   -> in the order of the file tree, as in vanilla files (default)\n"
+                 "path   -> ordered by path, keeping folders together\n"
+                 "size   -> grouped by size, smallest first\n"
+                 "access -> in the order of --access-log, other files by path");
+    pack_options("access-log",
+                 po::value<std::string>(),
+                 "for --layout=access, a text file with one path per line in the order the game reads them");
+    pack_options("align",
+                 po::value<uint64_t>()->implicit_value(4096),
+                 "align the data of every file to the given number of bytes, 4096 if not given");
 
     po::options_description unpack_desc("MVGL Unpack Options", 120);
     auto unpack_options = unpack_desc.add_options();
@@ -24,6 +24,17 @@ namespace doboz {
 
 using namespace detail;
 
+namespace {
+
+// Search parameters of the faster compression levels
+// The candidate count limits the hash chain walk, the search stops early once a match of nice length has been found
+const int GREEDY_MAX_CANDIDATE_COUNT = 4;
+const int GREEDY_NICE_LENGTH = 32;
+const int LAZY_MAX_CANDIDATE_COUNT = 16;
+const int LAZY_NICE_LENGTH = 128;
+
+} // namespace
+
 Result Compressor::compress(const void* source, size_t sourceSize, void* destination, size_t destinationSize, size_t& compressedSize)
 {
 	assert(source != 0);
@@ -185,6 +196,336 @@ Result Compressor::compress(const void* source, size_t sourceSize, void* destina
 	return RESULT_OK;
 }
 
+Result Compressor::compress(const void* source, size_t sourceSize, void* destination, size_t destinationSize, size_t& compressedSize, CompressionLevel level)
+{
+	// The hash chain only supports buffers smaller than 2 GB, larger ones always use the binary tree
+	if (level == COMPRESSION_LEVEL_BEST || sourceSize >= static_cast<size_t>(INT_MAX))
+	{
+		return compress(source, sourceSize, destination, destinationSize, compressedSize);
+	}
+
+	if (level == COMPRESSION_LEVEL_GREEDY)
+	{
+		return compressHashChain(source, sourceSize, destination, destinationSize, compressedSize, GREEDY_MAX_CANDIDATE_COUNT, GREEDY_NICE_LENGTH, false);
+	}
+
+	return compressHashChain(source, sourceSize, destination, destinationSize, compressedSize, LAZY_MAX_CANDIDATE_COUNT, LAZY_NICE_LENGTH, true);
+}
+
+// Compresses using the hash chain match finder, with or without lazy evaluation
+Result Compressor::compressHashChain(const void* source, size_t sourceSize, void* destination, size_t destinationSize, size_t& compressedSize, int maxCandidateCount, int niceLength, bool lazy)
+{
+	assert(source != 0);
+	assert(destination != 0);
+
+	if (sourceSize == 0)
+	{
+		return RESULT_ERROR_BUFFER_TOO_SMALL;
+	}
+
+	uint64_t maxCompressedSize = getMaxCompressedSize(sourceSize);
+	if (destinationSize < maxCompressedSize)
+	{
+		return RESULT_ERROR_BUFFER_TOO_SMALL;
+	}
+
+	const uint8_t* inputBuffer = static_cast<const uint8_t*>(source);
+	uint8_t* outputBuffer = static_cast<uint8_t*>(destination);
+	assert((inputBuffer + sourceSize <= outputBuffer || inputBuffer >= outputBuffer + destinationSize) && "The source and destination buffers must not overlap.");
+
+	uint8_t* maxOutputEnd = outputBuffer + static_cast<size_t>(maxCompressedSize);
+
+	hashChain_.setBuffer(inputBuffer, sourceSize);
+
+	OutputState output;
+	beginOutput(output, outputBuffer, maxCompressedSize);
+
+	const int inputLength = static_cast<int>(sourceSize);
+	int position = 0;
+
+	// The match at the next position, if the lazy evaluation has already looked for it
+	Match nextMatch;
+	nextMatch.length = 0;
+	bool hasNextMatch = false;
+
+	while (position < inputLength)
+	{
+		if (!beginToken(output, maxOutputEnd))
+		{
+			// Stop the compression and instead store
+			return store(source, sourceSize, destination, compressedSize);
+		}
+
+		Match match = hasNextMatch ? nextMatch : hashChain_.findMatch(position, maxCandidateCount, niceLength);
+		hashChain_.insert(position);
+		hasNextMatch = false;
+
+		// Only use matches which can be coded efficiently (coded size is less than the length)
+		if (match.length > 0 && match.length <= getMatchCodedSize(match))
+		{
+			match.length = 0;
+		}
+
+		// Same lazy evaluation as the binary tree encoder, matches of nice length are taken right away
+		if (lazy && match.length > 0 && match.length < niceLength)
+		{
+			nextMatch = hashChain_.findMatch(position + 1, maxCandidateCount, niceLength);
+			hasNextMatch = true;
+
+			if (nextMatch.length > 0 && nextMatch.length <= getMatchCodedSize(nextMatch))
+			{
+				nextMatch.length = 0;
+			}
+
+			if (nextMatch.length > 0 && (1 + nextMatch.length) * getMatchCodedSize(match) > match.length * (1 + getMatchCodedSize(nextMatch)))
+			{
+				match.length = 0;
+			}
+		}
+
+		if (match.length == 0)
+		{
+			outputLiteral(output, inputBuffer[position]);
+			++position;
+		}
+		else
+		{
+			outputMatch(output, match);
+
+			// Insert the matched positions, the next position might have been searched but has not been inserted yet
+			for (int i = 1; i < match.length; ++i)
+			{
+				hashChain_.insert(position + i);
+			}
+
+			position += match.length;
+			hasNextMatch = false;
+		}
+	}
+
+	return endOutput(output, outputBuffer, sourceSize, maxCompressedSize, compressedSize);
+}
+
+// Parses a region of the source with the binary tree match finder
+// The dictionary is seeded with the preceding window, so the result only differs from a whole block parse near the region end
+void Compressor::parseRegion(const void* source, size_t regionBegin, size_t regionEnd, std::vector<Sequence>& sequences)
+{
+	assert(source != 0);
+	assert(regionBegin < regionEnd);
+
+	const uint8_t* inputBuffer = static_cast<const uint8_t*>(source);
+
+	// Matches can't reference data further back than the dictionary size, so the window before that can be ignored
+	size_t windowBegin = regionBegin - std::min(regionBegin, static_cast<size_t>(DICTIONARY_SIZE));
+	size_t bufferLength = regionEnd - windowBegin;
+
+	// The buffer ends with the region, so the dictionary doesn't return matches extending beyond it
+	dictionary_.setBuffer(inputBuffer + windowBegin, bufferLength);
+
+	// Seed the dictionary with the window
+	for (size_t i = windowBegin; i < regionBegin; ++i)
+	{
+		dictionary_.skip();
+	}
+
+	Match matchCandidates[MAX_MATCH_CANDIDATE_COUNT];
+	int matchCandidateCount;
+
+	// Find the match at the beginning of the region, the dictionary matching look-ahead is 1 character
+	matchCandidateCount = dictionary_.findMatches(matchCandidates);
+	Match nextMatch = getBestMatch(matchCandidates, matchCandidateCount);
+	Match match;
+
+	Sequence sequence;
+	sequence.literalCount = 0;
+	sequence.match.length = 0;
+	sequences.clear();
+
+	// Same loop as the binary tree encoder, but the literals and matches are collected instead of being encoded
+	while (dictionary_.position() - 1 < bufferLength)
+	{
+		match = nextMatch;
+
+		matchCandidateCount = dictionary_.findMatches(matchCandidates);
+		nextMatch = getBestMatch(matchCandidates, matchCandidateCount);
+
+		if (match.length > 0 && (1 + nextMatch.length) * getMatchCodedSize(match) > match.length * (1 + getMatchCodedSize(nextMatch)))
+		{
+			match.length = 0;
+		}
+
+		if (match.length == 0)
+		{
+			++sequence.literalCount;
+		}
+		else
+		{
+			sequence.match = match;
+			sequences.push_back(sequence);
+
+			sequence.literalCount = 0;
+			sequence.match.length = 0;
+
+			for (int i = 0; i < match.length - 2; ++i)
+			{
+				dictionary_.skip();
+			}
+
+			matchCandidateCount = dictionary_.findMatches(matchCandidates);
+			nextMatch = getBestMatch(matchCandidates, matchCandidateCount);
+		}
+	}
+
+	if (sequence.literalCount > 0)
+	{
+		sequences.push_back(sequence);
+	}
+}
+
+// Encodes the parsed sequences of all regions into a single compressed block
+Result Compressor::compressRegions(const void* source, size_t sourceSize, const std::vector<Sequence>* regions, size_t regionCount, void* destination, size_t destinationSize, size_t& compressedSize)
+{
+	assert(source != 0);
+	assert(destination != 0);
+
+	if (sourceSize == 0)
+	{
+		return RESULT_ERROR_BUFFER_TOO_SMALL;
+	}
+
+	uint64_t maxCompressedSize = getMaxCompressedSize(sourceSize);
+	if (destinationSize < maxCompressedSize)
+	{
+		return RESULT_ERROR_BUFFER_TOO_SMALL;
+	}
+
+	const uint8_t* inputBuffer = static_cast<const uint8_t*>(source);
+	uint8_t* outputBuffer = static_cast<uint8_t*>(destination);
+	assert((inputBuffer + sourceSize <= outputBuffer || inputBuffer >= outputBuffer + destinationSize) && "The source and destination buffers must not overlap.");
+
+	uint8_t* maxOutputEnd = outputBuffer + static_cast<size_t>(maxCompressedSize);
+
+	OutputState output;
+	beginOutput(output, outputBuffer, maxCompressedSize);
+
+	size_t position = 0;
+
+	for (size_t i = 0; i < regionCount; ++i)
+	{
+		for (size_t j = 0; j < regions[i].size(); ++j)
+		{
+			const Sequence& sequence = regions[i][j];
+
+			// The sequences must not extend beyond the source
+			if (position + sequence.literalCount + sequence.match.length > sourceSize)
+			{
+				return RESULT_ERROR_CORRUPTED_DATA;
+			}
+
+			for (uint32_t k = 0; k < sequence.literalCount; ++k)
+			{
+				if (!beginToken(output, maxOutputEnd))
+				{
+					return store(source, sourceSize, destination, compressedSize);
+				}
+
+				outputLiteral(output, inputBuffer[position++]);
+			}
+
+			if (sequence.match.length > 0)
+			{
+				if (!beginToken(output, maxOutputEnd))
+				{
+					return store(source, sourceSize, destination, compressedSize);
+				}
+
+				outputMatch(output, sequence.match);
+				position += sequence.match.length;
+			}
+		}
+	}
+
+	// The regions must cover the whole source
+	if (position != sourceSize)
+	{
+		return RESULT_ERROR_CORRUPTED_DATA;
+	}
+
+	return endOutput(output, outputBuffer, sourceSize, maxCompressedSize, compressedSize);
+}
+
+// Allocates the header and the first control word
+void Compressor::beginOutput(OutputState& state, uint8_t* outputBuffer, uint64_t maxCompressedSize)
+{
+	state.iterator = outputBuffer + getHeaderSize(maxCompressedSize);
+	state.controlWord = 1u << (WORD_SIZE * 8 - 1);
+	state.controlWordBit = 0;
+	state.controlWordPointer = state.iterator;
+	state.iterator += WORD_SIZE;
+}
+
+// Prepares the output for the next literal or match
+// Returns false if the output would become larger than the stored data
+bool Compressor::beginToken(OutputState& state, const uint8_t* maxOutputEnd)
+{
+	// We may output up to 8 bytes (2 words), and the compressed stream ends with 4 dummy bytes
+	if (state.iterator + 2 * WORD_SIZE + TRAILING_DUMMY_SIZE > maxOutputEnd)
+	{
+		return false;
+	}
+
+	// Check whether the control word must be flushed
+	const int controlWordBitCount = WORD_SIZE * 8 - 1;
+	if (state.controlWordBit == controlWordBitCount)
+	{
+		fastWrite(state.controlWordPointer, state.controlWord, WORD_SIZE);
+
+		state.controlWord = 1u << controlWordBitCount;
+		state.controlWordBit = 0;
+
+		state.controlWordPointer = state.iterator;
+		state.iterator += WORD_SIZE;
+	}
+
+	return true;
+}
+
+void Compressor::outputLiteral(OutputState& state, uint8_t literal)
+{
+	// Literals use a 0 control word flag
+	*state.iterator++ = literal;
+	++state.controlWordBit;
+}
+
+void Compressor::outputMatch(OutputState& state, const Match& match)
+{
+	// Matches use a 1 control word flag
+	state.controlWord |= 1u << state.controlWordBit;
+	state.iterator += encodeMatch(match, state.iterator);
+	++state.controlWordBit;
+}
+
+// Flushes the last control word, appends the trailing dummy bytes and encodes the header
+Result Compressor::endOutput(OutputState& state, uint8_t* outputBuffer, size_t sourceSize, uint64_t maxCompressedSize, size_t& compressedSize)
+{
+	fastWrite(state.controlWordPointer, state.controlWord, WORD_SIZE);
+
+	fastWrite(state.iterator, 0, TRAILING_DUMMY_SIZE);
+	state.iterator += TRAILING_DUMMY_SIZE;
+
+	compressedSize = state.iterator - outputBuffer;
+
+	Header header;
+	header.version = VERSION;
+	header.isStored = false;
+	header.uncompressedSize = sourceSize;
+	header.compressedSize = compressedSize;
+
+	encodeHeader(header, maxCompressedSize, outputBuffer);
+
+	return RESULT_OK;
+}
+
 // Store the source
 Result Compressor::store(const void* source, size_t sourceSize, void* destination, size_t& compressedSize)
 {
@@ -18,11 +18,28 @@
 
 #pragma once
 
+#include <vector>
 #include "Common.h"
 #include "Dictionary.h"
 
 namespace doboz {
 
+// The compression levels, all of them produce the same stream format
+enum CompressionLevel
+{
+	COMPRESSION_LEVEL_GREEDY, // hash chain match finder, always takes the best match at the current position
+	COMPRESSION_LEVEL_LAZY, // hash chain match finder with lazy evaluation of the next position
+	COMPRESSION_LEVEL_BEST, // binary tree match finder with lazy evaluation, the original Doboz encoder
+};
+
+// A run of literals followed by a match, as found by parsing a region of the source
+// The match length is 0 if the run is not followed by a match
+struct Sequence
+{
+	uint32_t literalCount;
+	detail::Match match;
+};
+
 class Compressor
 {
 public:
@@ -36,8 +53,32 @@ public:
 	// On success, returns RESULT_OK and outputs the compressed size
 	Result compress(const void* source, size_t sourceSize, void* destination, size_t destinationSize, size_t& compressedSize);
 
+	// Compresses a block of data using the specified compression level
+	// Same requirements as above
+	Result compress(const void* source, size_t sourceSize, void* destination, size_t destinationSize, size_t& compressedSize, CompressionLevel level);
+
+	// Large blocks can be compressed in two stages, which allows parsing different regions in parallel
+	// First every region is parsed into sequences, using a separate Compressor object per thread
+	// The matches of a region may reference the preceding DICTIONARY_SIZE bytes, but never extend beyond the region
+	// Parsing uses the same match finder and lazy evaluation as the best compression level
+	void parseRegion(const void* source, size_t regionBegin, size_t regionEnd, std::vector<Sequence>& sequences);
+
+	// Then the sequences of all regions, in order and covering the whole source, are encoded into a single compressed block
+	// Same requirements as above
+	Result compressRegions(const void* source, size_t sourceSize, const std::vector<Sequence>* regions, size_t regionCount, void* destination, size_t destinationSize, size_t& compressedSize);
+
 private:
+	// The state of the compressed output, shared by the encoding loops
+	struct OutputState
+	{
+		uint8_t* iterator;
+		uint8_t* controlWordPointer;
+		uint32_t controlWord;
+		int controlWordBit;
+	};
+
 	detail::Dictionary dictionary_;
+	detail::HashChain hashChain_;
 
 	static int getSizeCodedSize(uint64_t size);
 	static int getHeaderSize(uint64_t maxCompressedSize);
@@ -47,6 +88,13 @@ private:
 	int encodeMatch(const detail::Match& match, void* destination);
 	int getMatchCodedSize(const detail::Match& match);
 	void encodeHeader(const detail::Header& header, uint64_t maxCompressedSize, void* destination);
+
+	Result compressHashChain(const void* source, size_t sourceSize, void* destination, size_t destinationSize, size_t& compressedSize, int maxCandidateCount, int niceLength, bool lazy);
+	void beginOutput(OutputState& state, uint8_t* outputBuffer, uint64_t maxCompressedSize);
+	bool beginToken(OutputState& state, const uint8_t* maxOutputEnd);
+	void outputLiteral(OutputState& state, uint8_t literal);
+	void outputMatch(OutputState& state, const detail::Match& match);
+	Result endOutput(OutputState& state, uint8_t* outputBuffer, size_t sourceSize, uint64_t maxCompressedSize, size_t& compressedSize);
 };
 
 } // namespace doboz
\ No newline at end of file
@@ -16,6 +16,8 @@
  * 3. This notice may not be removed or altered from any source distribution.
  */
 
+#include <algorithm>
+#include <bit>
 #include <cstring>
 #include "Decompressor.h"
 
@@ -23,6 +25,19 @@ namespace doboz {
 
 using namespace detail;
 
+namespace {
+
+// The number of bytes copied at once by the fast decoding loop
+// Literal runs are copied with WILD_COPY_LENGTH bytes, matches which don't overlap within a chunk with MATCH_COPY_LENGTH bytes
+const int WILD_COPY_LENGTH = 32;
+const int MATCH_COPY_LENGTH = 16;
+
+// The fast decoding loop may read and write this many bytes beyond the current positions
+const int FAST_INPUT_MARGIN = WORD_SIZE + WILD_COPY_LENGTH;
+const int FAST_OUTPUT_MARGIN = MAX_MATCH_LENGTH + MATCH_COPY_LENGTH;
+
+} // namespace
+
 Result Decompressor::decompress(const void* source, size_t sourceSize, void* destination, size_t destinationSize)
 {
 	assert(source != 0);
@@ -79,7 +94,102 @@ Result Decompressor::decompress(const void* source, size_t sourceSize, void* des
 	// Initialize the control word to 'empty'
 	uint32_t controlWord = 1;
 
-	// Decoding loop
+	// Fast decoding loop
+	// As long as there is enough room left in both buffers, literals and matches are copied in large chunks which may
+	// write beyond their actual end. The remaining data is decoded by the careful loop below.
+	if (header.compressedSize > static_cast<uint64_t>(headerSize + FAST_INPUT_MARGIN) &&
+		uncompressedSize > static_cast<size_t>(FAST_OUTPUT_MARGIN + TAIL_LENGTH) &&
+		destinationSize > static_cast<size_t>(FAST_OUTPUT_MARGIN))
+	{
+		const uint8_t* inputFastEnd = inputEnd - FAST_INPUT_MARGIN;
+		uint8_t* outputFastEnd = std::min(outputTail - WILD_COPY_LENGTH, outputBuffer + destinationSize - FAST_OUTPUT_MARGIN);
+
+		while (inputIterator < inputFastEnd && outputIterator < outputFastEnd)
+		{
+			// Check whether we must read a control word
+			if (controlWord == 1)
+			{
+				controlWord = fastRead(inputIterator, WORD_SIZE);
+				inputIterator += WORD_SIZE;
+			}
+
+			if ((controlWord & 1) == 0)
+			{
+				// It's a run of literals, which ends at the next match bit or at the guard bit
+				// A control word without any set bit lacks the guard bit, so it can only come from corrupted data
+				if (controlWord == 0)
+				{
+					return RESULT_ERROR_CORRUPTED_DATA;
+				}
+
+				// Copy implicitly WILD_COPY_LENGTH literals regardless of the run length, the run is at most 31 long
+				int runLength = std::countr_zero(controlWord);
+
+				std::memcpy(outputIterator, inputIterator, MATCH_COPY_LENGTH);
+				std::memcpy(outputIterator + MATCH_COPY_LENGTH, inputIterator + MATCH_COPY_LENGTH, MATCH_COPY_LENGTH);
+
+				inputIterator += runLength;
+				outputIterator += runLength;
+				controlWord >>= runLength;
+			}
+			else
+			{
+				// It's a match
+				Match match;
+				inputIterator += decodeMatch(match, inputIterator);
+
+				uint8_t* matchString = outputIterator - match.offset;
+
+				// Check whether the match is out of range
+				if (matchString < outputBuffer || outputIterator + match.length > outputTail)
+				{
+					return RESULT_ERROR_CORRUPTED_DATA;
+				}
+
+				int i = 0;
+
+				if (match.offset >= MATCH_COPY_LENGTH)
+				{
+					// The chunks don't overlap, so we can copy the match in large chunks
+					do
+					{
+						std::memcpy(outputIterator + i, matchString + i, MATCH_COPY_LENGTH);
+						i += MATCH_COPY_LENGTH;
+					}
+					while (i < match.length);
+				}
+				else
+				{
+					// Same as the careful loop: copy the first three bytes one by one for small offsets, then words
+					if (match.offset < WORD_SIZE)
+					{
+						do
+						{
+							outputIterator[i] = matchString[i];
+							++i;
+						}
+						while (i < 3);
+
+						matchString -= 2 + (match.offset & 1);
+					}
+
+					do
+					{
+						fastWrite(outputIterator + i, fastRead(matchString + i, WORD_SIZE), WORD_SIZE);
+						i += WORD_SIZE;
+					}
+					while (i < match.length);
+				}
+
+				outputIterator += match.length;
+
+				// Next control word bit
+				controlWord >>= 1;
+			}
+		}
+	}
+
+	// Careful decoding loop
 	for (; ;)
 	{
 		// Check whether there is enough data left in the input buffer
@@ -276,5 +276,139 @@ uint32_t Dictionary::hash(const uint8_t* data)
 	return result;
 }
 
+HashChain::HashChain()
+	: buffer_(0), bufferLength_(0), matchableBufferLength_(0), head_(0), chain_(0), hashBits_(0), chainMask_(0), headCapacity_(0), chainCapacity_(0)
+{
+}
+
+HashChain::~HashChain()
+{
+	delete[] head_;
+	delete[] chain_;
+}
+
+void HashChain::setBuffer(const uint8_t* buffer, size_t bufferLength)
+{
+	assert(bufferLength < static_cast<size_t>(INT_MAX) && "Buffer too large for the hash chain.");
+
+	buffer_ = buffer;
+	bufferLength_ = static_cast<int>(bufferLength);
+
+	// Compute the matchable buffer length, same as for the Dictionary
+	if (bufferLength_ > TAIL_LENGTH + MIN_MATCH_LENGTH)
+	{
+		matchableBufferLength_ = bufferLength_ - (TAIL_LENGTH + MIN_MATCH_LENGTH);
+	}
+	else
+	{
+		matchableBufferLength_ = 0;
+	}
+
+	// Size the tables after the buffer, every position fits into the chain as long as the buffer is smaller than the dictionary
+	int bufferBits = 0;
+	while (bufferBits < 31 && (1 << bufferBits) < bufferLength_)
+	{
+		++bufferBits;
+	}
+
+	hashBits_ = std::min(std::max(bufferBits, static_cast<int>(MIN_HASH_BITS)), static_cast<int>(MAX_HASH_BITS));
+	size_t chainSize = std::min(static_cast<size_t>(1) << bufferBits, static_cast<size_t>(DICTIONARY_SIZE));
+	size_t headSize = static_cast<size_t>(1) << hashBits_;
+	chainMask_ = static_cast<int>(chainSize - 1);
+
+	if (headCapacity_ < headSize)
+	{
+		delete[] head_;
+		head_ = new int[headSize];
+		headCapacity_ = headSize;
+	}
+
+	if (chainCapacity_ < chainSize)
+	{
+		delete[] chain_;
+		chain_ = new int[chainSize];
+		chainCapacity_ = chainSize;
+	}
+
+	// Only the head table has to be cleared, the chain entries are always written before they are read
+	for (size_t i = 0; i < headSize; ++i)
+	{
+		head_[i] = INVALID_POSITION;
+	}
+}
+
+Match HashChain::findMatch(int position, int maxCandidateCount, int niceLength) const
+{
+	Match bestMatch;
+	bestMatch.length = 0;
+	bestMatch.offset = 0;
+
+	if (position >= matchableBufferLength_)
+	{
+		return bestMatch;
+	}
+
+	// The match must end before the tail and must not exceed the dictionary
+	int maxMatchLength = std::min(bufferLength_ - TAIL_LENGTH - position, MAX_MATCH_LENGTH);
+	int minMatchPosition = std::max(position - std::min(DICTIONARY_SIZE, chainMask_ + 1) + 1, 0);
+
+	const uint8_t* current = buffer_ + position;
+	int matchPosition = head_[hash(current)];
+
+	for (int i = 0; i < maxCandidateCount && matchPosition >= minMatchPosition; ++i)
+	{
+		const uint8_t* candidate = buffer_ + matchPosition;
+
+		// Only a longer match is interesting, so check the byte that would extend the best match first
+		if (candidate[bestMatch.length] == current[bestMatch.length])
+		{
+			int matchLength = 0;
+			while (matchLength < maxMatchLength && candidate[matchLength] == current[matchLength])
+			{
+				++matchLength;
+			}
+
+			if (matchLength > bestMatch.length)
+			{
+				bestMatch.length = matchLength;
+				bestMatch.offset = position - matchPosition;
+
+				if (matchLength >= niceLength || matchLength == maxMatchLength)
+				{
+					break;
+				}
+			}
+		}
+
+		matchPosition = chain_[matchPosition & chainMask_];
+	}
+
+	if (bestMatch.length < MIN_MATCH_LENGTH)
+	{
+		bestMatch.length = 0;
+	}
+
+	return bestMatch;
+}
+
+void HashChain::insert(int position)
+{
+	if (position >= matchableBufferLength_)
+	{
+		return;
+	}
+
+	uint32_t hashValue = hash(buffer_ + position);
+	chain_[position & chainMask_] = head_[hashValue];
+	head_[hashValue] = position;
+}
+
+uint32_t HashChain::hash(const uint8_t* data) const
+{
+	// Multiplicative hash of the first 3 bytes, the minimum match length
+	uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+	return (value * 2654435761u) >> (32 - hashBits_);
+}
+
 } // namespace detail
 } // namespace doboz
\ No newline at end of file
@@ -62,5 +62,48 @@ private:
 	uint32_t hash(const uint8_t* data);
 };
 
+// Hash chain match finder used by the faster compression levels
+// It checks far fewer candidates than the binary tree Dictionary, but only supports buffers smaller than 2 GB
+class HashChain
+{
+public:
+	HashChain();
+	~HashChain();
+
+	void setBuffer(const uint8_t* buffer, size_t bufferLength);
+
+	// Finds the longest match at the specified position, checking at most maxCandidateCount candidates
+	// The search stops early once a match of at least niceLength has been found
+	// The position itself must not have been inserted yet
+	Match findMatch(int position, int maxCandidateCount, int niceLength) const;
+
+	// Inserts the specified position into the chains, positions must be inserted in increasing order
+	void insert(int position);
+
+	int matchableLength() const
+	{
+		return matchableBufferLength_;
+	}
+
+private:
+	static const int MAX_HASH_BITS = 17;
+	static const int MIN_HASH_BITS = 10;
+	static const int INVALID_POSITION = -1;
+
+	const uint8_t* buffer_;
+	int bufferLength_;
+	int matchableBufferLength_;
+
+	// The tables are sized after the buffer, so compressing small buffers stays cheap
+	int* head_; // most recent position for every hash value
+	int* chain_; // previous position with the same hash value, indexed by position & chainMask_
+	int hashBits_;
+	int chainMask_;
+	size_t headCapacity_;
+	size_t chainCapacity_;
+
+	uint32_t hash(const uint8_t* data) const;
+};
+
 } // namespace detail
 } // namespace doboz
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "Compressors.h"
+#include "Parallel.h"
+
+#include <lz4.h>
+#include <lz4hc.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    // must match Compressors.cpp, the interesting sizes are those around where the input gets split
+    constexpr size_t LZ4_PARALLEL_THRESHOLD = 16 * 1024 * 1024;
+    constexpr size_t LZ4_CHUNK_SIZE         = 4 * 1024 * 1024;
+    constexpr size_t MIB                    = 1024 * 1024;
+
+    enum class Pattern
+    {
+        ZERO,
+        RANDOM,
+        TEXT,
+        // random data around every chunk boundary, so every chunk ends with a long literal run
+        BOUNDARY_LITERALS,
+    };
+
+    constexpr auto toString(Pattern pattern) -> std::string_view
+    {
+        switch (pattern)
+        {
+            case Pattern::ZERO: return "zero";
+            case Pattern::RANDOM: return "random";
+            case Pattern::TEXT: return "text";
+            case Pattern::BOUNDARY_LITERALS: return "boundary literals";
+        }
+        return "";
+    }
+
+    auto generate(Pattern pattern, size_t size) -> std::vector<char>
+    {
+        std::vector<char> data(size);
+        // a fixed seed, so failures can be reproduced
+        std::mt19937_64 rng(size);
+
+        switch (pattern)
+        {
+            case Pattern::ZERO: break;
+            case Pattern::RANDOM:
+                for (auto& val : data)
+                    val = static_cast<char>(rng());
+                break;
+            case Pattern::TEXT:
+            {
+                constexpr std::array<std::string_view, 12> WORDS = {
+                    "digimon ", "story ", "cyber ", "sleuth ", "agumon ", "gabumon ",
+                    "data ",    "mvgl ",  "table, ", "entry\n", "1024 ",  "\"quoted\" ",
+                };
+                for (size_t i = 0; i < size;)
+                    for (auto chr : WORDS[rng() % WORDS.size()])
+                        if (i < size) data[i++] = chr;
+                break;
+            }
+            case Pattern::BOUNDARY_LITERALS:
+                for (size_t boundary = LZ4_CHUNK_SIZE; boundary < size + LZ4_CHUNK_SIZE; boundary += LZ4_CHUNK_SIZE)
+                {
+                    auto start = boundary - std::min<size_t>(boundary, 100 * 1024);
+                    for (auto i = start; i < std::min(boundary + 1000, size); i++)
+                        data[i] = static_cast<char>(rng());
+                }
+                break;
+        }
+
+        return data;
+    }
+
+    auto checkLZ4(Pattern pattern, size_t size, mvgltools::CompressionLevel level) -> bool
+    {
+        auto name  = std::format("LZ4 {} {} bytes level {}", toString(pattern), size, static_cast<int>(level));
+        auto input = generate(pattern, size);
+
+        auto compressed = mvgltools::LZ4::compress(input, level);
+        if (!compressed)
+        {
+            std::cout << "FAIL " << name << ": " << compressed.error() << "\n";
+            return false;
+        }
+
+        // decoded by LZ4 itself, so the stitched block has to be a valid block on its own
+        std::vector<char> output(size);
+        auto result = LZ4_decompress_safe(compressed->data(),
+                                          output.data(),
+                                          static_cast<int32_t>(compressed->size()),
+                                          static_cast<int32_t>(output.size()));
+        if (result != static_cast<int32_t>(size) || output != input)
+        {
+            std::cout << "FAIL " << name << ": decompressed " << result << " bytes, content differs\n";
+            return false;
+        }
+
+        std::cout << "ok   " << name << " -> " << compressed->size() << " bytes\n";
+        return true;
+    }
+
+    auto runTests() -> int
+    {
+        using enum mvgltools::CompressionLevel;
+
+        const std::vector<size_t> sizes = {
+            LZ4_PARALLEL_THRESHOLD - 1,
+            LZ4_PARALLEL_THRESHOLD,
+            LZ4_PARALLEL_THRESHOLD + 1,
+            (5 * LZ4_CHUNK_SIZE) - 1,
+            5 * LZ4_CHUNK_SIZE,
+            (5 * LZ4_CHUNK_SIZE) + 1,
+            (5 * LZ4_CHUNK_SIZE) + 4,
+            (6 * LZ4_CHUNK_SIZE) + 12,
+        };
+
+        bool success = true;
+        for (auto size : sizes)
+            for (auto pattern : {Pattern::ZERO, Pattern::RANDOM, Pattern::TEXT, Pattern::BOUNDARY_LITERALS})
+                success &= checkLZ4(pattern, size, FAST);
+
+        // the optimal parser creates other sequences at the chunk boundaries than the greedy one
+        success &= checkLZ4(Pattern::TEXT, LZ4_PARALLEL_THRESHOLD + 1, BEST);
+        success &= checkLZ4(Pattern::BOUNDARY_LITERALS, 5 * LZ4_CHUNK_SIZE, BALANCED);
+
+        std::cout << (success ? "All tests passed.\n" : "Some tests failed.\n");
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /**
+     * Times compressing a large synthetic entry, compared to compressing it as a single block on one thread.
+     */
+    auto runBenchmark(size_t size) -> int
+    {
+        using Clock = std::chrono::steady_clock;
+
+        auto input = generate(Pattern::TEXT, size);
+        std::cout << std::format(
+            "Compressing {} MiB of text-like data with {} threads\n", size / MIB, mvgltools::getThreadCount());
+
+        for (auto level : {mvgltools::CompressionLevel::FAST,
+                           mvgltools::CompressionLevel::BALANCED,
+                           mvgltools::CompressionLevel::BEST})
+        {
+            constexpr std::array<int32_t, 3> LEVELS = {LZ4HC_CLEVEL_MIN, LZ4HC_CLEVEL_DEFAULT, LZ4HC_CLEVEL_MAX};
+
+            auto start        = Clock::now();
+            auto parallel     = mvgltools::LZ4::compress(input, level);
+            auto parallelTime = std::chrono::duration<double>(Clock::now() - start).count();
+            if (!parallel)
+            {
+                std::cout << parallel.error() << "\n";
+                return EXIT_FAILURE;
+            }
+
+            std::vector<char> single(LZ4_compressBound(static_cast<int32_t>(size)));
+            start           = Clock::now();
+            auto singleSize = LZ4_compress_HC(input.data(),
+                                              single.data(),
+                                              static_cast<int32_t>(size),
+                                              static_cast<int32_t>(single.size()),
+                                              LEVELS.at(static_cast<size_t>(level)));
+            auto singleTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::cout << std::format("LZ4 level {}: {:.2f} s ({} bytes), single block {:.2f} s ({} bytes)\n",
+                                     static_cast<int>(level),
+                                     parallelTime,
+                                     parallel->size(),
+                                     singleTime,
+                                     singleSize);
+        }
+
+        return EXIT_SUCCESS;
+    }
+} // namespace
+
+/**
+ * Round-trip tests for the compressors, focused on the inputs that get split into chunks. Run with
+ * "--benchmark [MiB]" to time compressing a large synthetic entry instead.
+ */
+auto main(int argc, char** argv) -> int
+{
+    if (argc > 1 && std::string_view(argv[1]) == "--benchmark")
+        return runBenchmark((argc > 2 ? std::stoull(argv[2]) : 256) * MIB);
+
+    return runTests();
+}